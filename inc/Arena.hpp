@@ -0,0 +1,197 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ARENA_HPP_
+#define ARENA_HPP_
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * A bump allocator for the temporaries of a single generation. Memory is
+ * handed out from large chunks and is never freed individually, instead the
+ * whole arena is reset at the generation boundary. The chunks are kept across
+ * resets so once the arena has grown to the size of a generation no more calls
+ * are made to the heap.
+ *
+ * Each worker thread owns its own arena so no locking is required. The arena
+ * used by ArenaAllocator is selected per thread with ArenaScope.
+ */
+class GenerationArena {
+
+private:
+	struct Chunk {
+		char *memory;
+		std::size_t size;
+	};
+
+	std::vector<Chunk > chunks;
+	std::size_t chunk_size;
+
+	// The chunk currently being allocated from and the offset within it.
+	std::size_t current_chunk;
+	std::size_t offset;
+
+	unsigned long long chunk_allocations;
+
+public:
+
+	/**
+	 * Create an arena, no memory is allocated until the first allocation.
+	 * @param chunk_size The size in bytes of each chunk requested from the heap.
+	 */
+	GenerationArena(std::size_t chunk_size=1 << 16);
+
+	~GenerationArena();
+
+	/**
+	 * Allocate memory from the arena.
+	 * @param bytes The number of bytes.
+	 * @param alignment The alignment of the memory, must be a power of 2.
+	 * @return The memory, valid until the next reset.
+	 */
+	void *allocate(std::size_t bytes, std::size_t alignment);
+
+	/**
+	 * Release all the memory allocated since the last reset. The chunks are
+	 * kept for the next generation.
+	 */
+	void reset();
+
+	/**
+	 * Get the number of chunks that have been requested from the heap.
+	 */
+	unsigned long long getChunkAllocations();
+
+	/**
+	 * Get the arena selected for the calling thread.
+	 * @return The arena or NULL if the heap should be used.
+	 */
+	static GenerationArena *current();
+
+	/**
+	 * Select the arena for the calling thread.
+	 * @param arena The arena or NULL to use the heap.
+	 */
+	static void setCurrent(GenerationArena *arena);
+
+private:
+	GenerationArena(const GenerationArena &);
+	GenerationArena &operator=(const GenerationArena &);
+};
+
+/**
+ * Select an arena for the calling thread for the lifetime of the scope, the
+ * previous arena is restored afterwards. A NULL arena can be used to make
+ * sure long lived values are allocated on the heap.
+ */
+class ArenaScope {
+
+	GenerationArena *previous;
+
+public:
+
+	ArenaScope(GenerationArena *arena) {
+		previous = GenerationArena::current();
+		GenerationArena::setCurrent(arena);
+	}
+
+	~ArenaScope() {
+		GenerationArena::setCurrent(previous);
+	}
+};
+
+/**
+ * Allocator that takes its memory from the arena selected for the thread when
+ * the container is created, or the heap if there is none. Deallocation is a no
+ * op for arena memory. Copies of a container pick the arena of the copying
+ * thread so values escaping a generation can be copied out onto the heap.
+ */
+template <class T>
+class ArenaAllocator {
+
+public:
+	typedef T value_type;
+
+	GenerationArena *arena;
+
+	ArenaAllocator() : arena(GenerationArena::current()) {
+	}
+
+	template <class U>
+	ArenaAllocator(const ArenaAllocator<U > &other) : arena(other.arena) {
+	}
+
+	T *allocate(std::size_t n) {
+		if(arena) {
+			return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+		}
+		return static_cast<T *>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T *p, std::size_t) {
+		if(!arena) {
+			::operator delete(p);
+		}
+	}
+
+	ArenaAllocator select_on_container_copy_construction() const {
+		return ArenaAllocator();
+	}
+
+	template <class U>
+	struct rebind {
+		typedef ArenaAllocator<U > other;
+	};
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T > &a, const ArenaAllocator<U > &b) {
+	return a.arena == b.arena;
+}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T > &a, const ArenaAllocator<U > &b) {
+	return a.arena != b.arena;
+}
+
+/**
+ * Counts the calls to the global operator new. The counting operator new is
+ * only compiled in with GA_COUNT_ALLOCATIONS, otherwise the count stays 0.
+ */
+class AllocationCounter {
+public:
+
+	/**
+	 * Whether the calls to operator new are counted.
+	 */
+	static bool enabled();
+
+	/**
+	 * Get the number of calls to operator new since the start of the program.
+	 */
+	static unsigned long long count();
+};
+
+#endif /* ARENA_HPP_ */
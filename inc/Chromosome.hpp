@@ -27,21 +27,38 @@
 
 #include <vector>	  // vector
 #include <algorithm>  // swap_ranges
-#include <random>     // mt19937, uniform_int_distribution, random_device
+#include <random>     // mt19937, uniform_int_distribution, geometric_distribution, random_device
+
+#include <boost/functional/hash.hpp>
+
+#include "Arena.hpp"
 
 #define MINIMUM_NUMBER 0
 
+/**
+ * How two chromosomes are crossed over. ONE_POINT swaps the elements after a
+ * random point, TWO_POINT swaps the elements between two random points and
+ * UNIFORM swaps each element with a probability of one half.
+ */
+enum CrossoverType {
+	ONE_POINT,
+	TWO_POINT,
+	UNIFORM
+};
+
 template <class T>
 class Chromosome {
 
 protected:
-    std::vector<T > chromosome;
+    // Copies made by the worker threads are taken from their generation arena.
+    std::vector<T, ArenaAllocator<T > > chromosome;
 
-    // random number generator values.
-    static std::mt19937 random_engine;
-    static std::uniform_int_distribution<int> rand_chrom_elem;
+    // random number generator values. They are kept per thread so runs of different
+    // chromosome sizes and ranges can share the process, see initialize.
+    static thread_local std::mt19937 random_engine;
+    static thread_local std::uniform_int_distribution<int> rand_chrom_elem;
     // This only works with integer values
-    static std::uniform_int_distribution<int> rand_value;
+    static thread_local std::uniform_int_distribution<int> rand_value;
 
 
 public:
@@ -69,7 +86,7 @@ public:
      * @param chromosome the vector of elements that make up the chromosome.
      */
     Chromosome(std::vector<T> chromosome) {
-    	this->chromosome = chromosome;
+    	this->chromosome.assign(chromosome.begin(), chromosome.end());
     }
 
     /**
@@ -85,13 +102,14 @@ public:
     	population.clear();
     	for(unsigned int i = 0; i < population_size; i++) {
     		Chromosome<T> chrom(chromosome_size);
-    		chrom.randChromosome();
+    		chrom.randChromosome(random_engine);
     		population.push_back(chrom);
     	}
     }
 
     /**
-     * Set up the random number generator engines to allow within the defined ranges.
+     * Set up the random number generator engines to allow within the defined ranges,
+     * for the calling thread. The Manager calls this on each of its threads.
      * @param chromosome_size The size of the chromosome.
      * @param min_chromosome_value The minimum value of a chromosome element.
      * @param max_chromosome_value The maximum value of a chromosome element.
@@ -110,13 +128,46 @@ public:
      * @param children The next generation of chromosomes (the next population) that is currently being bread.
      */
     void mutate() {
+    	mutate(random_engine);
+    }
+
+    /**
+     * Apply the mutation operation to the chromosome using the given random
+     * number generator, this allows each thread to use its own generator.
+     * @param engine The random number generator.
+     */
+    void mutate(std::mt19937 &engine) {
     	//cloning(children);
 
     	// Identify element that will be changed
-    	unsigned int mutated_index = getRandomElement();
+    	unsigned int mutated_index = getRandomElement(engine);
 
         // Mutate the element
-    	mutateElement(mutated_index);
+    	mutateElement(mutated_index, engine);
+    }
+
+    /**
+     * Mutate each element of the chromosome with the given probability. The gaps
+     * between the mutated elements are drawn from a geometric distribution, so a
+     * random number is drawn per mutated element rather than per element.
+     * @param rate The probability of each element being mutated.
+     * @param engine The random number generator.
+     */
+    void mutate(double rate, std::mt19937 &engine) {
+    	if(rate <= 0) {
+    		return;
+    	}
+    	if(rate >= 1) {
+    		for(unsigned int i = 0; i < chromosome.size(); i++) {
+    			mutateElement(i, engine);
+    		}
+    		return;
+    	}
+
+    	std::geometric_distribution<unsigned int> skip(rate);
+    	for(unsigned long long i = skip(engine); i < chromosome.size(); i+= 1ull + skip(engine)) {
+    		mutateElement(i, engine);
+    	}
     }
 
     /**
@@ -141,14 +192,24 @@ public:
      * Where l1 and l2 are subsets of the chromosome = chromosome[0..crossover_site-1] for each respective chromosome
      * and r1 and r2 are subsets of the chromosome = chromosome[crossover_site..chromosome.size()-1] for each respective chromosome.
      */
-    void crossover(Chromosome<T> &other, std::vector<Chromosome<T> > &children) {
+    void crossover(const Chromosome<T> &other, std::vector<Chromosome<T> > &children) const {
+    	crossover(other, children, random_engine);
+    }
+
+    /**
+     * Apply the crossover operation using the given random number generator.
+     * @param other The second chromosome involved in the crossover operation
+     * @param children The next generation of the population.
+     * @param engine The random number generator.
+     */
+    void crossover(const Chromosome<T> &other, std::vector<Chromosome<T> > &children, std::mt19937 &engine) const {
     	// Copy value to the next population
         cloning(children);
     	// Copy other to the next population
         other.cloning(children);
 
     	// Randomly pick one point (where the cross over starts)
-    	int crossover_index = getRandomElement(0);
+    	int crossover_index = getRandomElement(0, engine);
 
     	// Using the index inclusive approach
     	// First gets l1 + r2 and second gets l2 + r1
@@ -160,11 +221,64 @@ public:
     	//std::swap_ranges((*(children.end()-2)).begin(), (*(children.end()-2)).begin()+(chromosome.size()-1-crossover_index)+1, (*(children.end()-1)).rbegin()+(chromosome.size()-1-crossover_index));
     }
 
+    /**
+     * Apply the crossover operation of the given type.
+     * @param other The second chromosome involved in the crossover operation
+     * @param children The next generation of the population.
+     * @param engine The random number generator.
+     * @param type The type of crossover.
+     */
+    void crossover(const Chromosome<T> &other, std::vector<Chromosome<T> > &children, std::mt19937 &engine,
+    		CrossoverType type) const {
+    	unsigned int size = std::min(chromosome.size(), other.chromosome.size());
+    	if(type == ONE_POINT || size < 2) {
+    		crossover(other, children, engine);
+    		return;
+    	}
+
+        cloning(children);
+        other.cloning(children);
+        Chromosome<T> &first = *(children.end()-2);
+        Chromosome<T> &second = *(children.end()-1);
+
+    	if(type == TWO_POINT) {
+    		std::uniform_int_distribution<unsigned int> point_dist(0, size);
+    		unsigned int start = point_dist(engine);
+    		unsigned int end = point_dist(engine);
+    		if(start > end) {
+    			std::swap(start, end);
+    		}
+    		std::swap_ranges(first.chromosome.begin()+start, first.chromosome.begin()+end, second.chromosome.begin()+start);
+    		return;
+    	}
+
+    	// A mask of which elements are swapped, each random number gives the bits of 32 elements.
+    	static thread_local std::vector<unsigned char> mask;
+    	mask.resize(size);
+    	for(unsigned int i = 0; i < size; i+= 32) {
+    		unsigned int bits = engine();
+    		for(unsigned int j = 0; j < 32 && i + j < size; j++) {
+    			mask[i + j] = (bits >> j) & 1;
+    		}
+    	}
+
+    	// Branch free selects over contiguous storage, compiled to vector blends.
+    	const T *a = chromosome.data();
+    	const T *b = other.chromosome.data();
+    	T *x = first.chromosome.data();
+    	T *y = second.chromosome.data();
+    	const unsigned char *m = mask.data();
+    	for(unsigned int i = 0; i < size; i++) {
+    		x[i] = m[i] ? b[i] : a[i];
+    		y[i] = m[i] ? a[i] : b[i];
+    	}
+    }
+
     /**
      * Copy the chromosome to the next generation.
      * @param children The next generation.
      */
-    void cloning(std::vector<Chromosome<T> > &children) {
+    void cloning(std::vector<Chromosome<T> > &children) const {
     	// Copy value to the next population
     	children.push_back(*this);
     }
@@ -182,10 +296,28 @@ public:
      * Get the size of the chromosome
      * @return
      */
-	unsigned int size() {
+	unsigned int size() const {
 		return this->chromosome.size();
 	}
 
+    /**
+     * Change the size of the chromosome.
+     * @param chromosome_size The new size of the chromosome.
+     */
+    void resize(unsigned int chromosome_size) {
+    	this->chromosome.resize(chromosome_size);
+    }
+
+    /**
+     * Set every element of the chromosome to a random value.
+     * @param engine The random number generator.
+     */
+    void randChromosome(std::mt19937 &engine) {
+		for(unsigned int i = 0; i < chromosome.size(); i++) {
+			chromosome[i] = getRandomValue(engine);
+		}
+    }
+
     /**
      * Overload the array operator
      * @param n The index to retrieve the value at.
@@ -200,35 +332,48 @@ public:
      * @param other The Chromosome to compare too.
      * @return Whether the two chromosomes are the same.
      */
-    inline bool operator==(const Chromosome<T>& other){ return this->chromosome == other.chromosome; }
+    inline bool operator==(const Chromosome<T>& other) const { return this->chromosome == other.chromosome; }
 
     /**
      * Overload the != operation, makes use of == operator overload
      * @param other The chromosome to check equality.
      * @return Whether the two chromosomes are different.
      */
-    inline bool operator!=(const Chromosome<T>& other){ return !(*this == other); }
+    inline bool operator!=(const Chromosome<T>& other) const { return !(*this == other); }
+
+    /**
+     * Hash the elements of the chromosome.
+     * @return The hash of the chromosome.
+     */
+    std::size_t hash() const {
+        return boost::hash_range(this->chromosome.begin(), this->chromosome.end());
+    }
 
 private:
 
     /**
      * Get a random index to allow for the retrieval a random element within the chromosome.
+     * The shared distribution only provides the range, a local copy is used so
+     * threads with their own engine do not share any state.
+     * @param engine The random number generator.
      * @return The random index.
      */
-    unsigned int getRandomElement() {
-    	return rand_chrom_elem(random_engine);
+    unsigned int getRandomElement(std::mt19937 &engine) const {
+    	std::uniform_int_distribution<int> dist(rand_chrom_elem.param());
+    	return dist(engine);
     }
 
 	/**
 	 * Get a random number between 0 and chromosome.size()-1 that is not index
 	 * @param index The only value within the range that the return cannot be.
+	 * @param engine The random number generator.
 	 * @return A number within the defined range that is not index.
 	 */
-	unsigned int getRandomElement(unsigned int index) {
-		unsigned int val = getRandomElement();
+	unsigned int getRandomElement(unsigned int index, std::mt19937 &engine) const {
+		unsigned int val = getRandomElement(engine);
 
 		while(val == index) {
-			val = getRandomElement();
+			val = getRandomElement(engine);
 		}
 		return val;
 	}
@@ -236,8 +381,9 @@ private:
 	/**
 	 * Mutate the given element within the chromosome
 	 * @param mutated_index The index of the element within the chromosome that will be mutated.
+	 * @param engine The random number generator.
 	 */
-    void mutateElement(unsigned int mutated_index) {
+    void mutateElement(unsigned int mutated_index, std::mt19937 &engine) {
         // Could check if it is none primitive and call an expected function
         // Aka all 'data' types that are passed (that are not bool or int) are a child of a abstract class Gene
         // This will define a abstract accessor methods static method Gene::randomElement(Gene)
@@ -249,49 +395,50 @@ private:
     	} else { 
     		// This will really only works for 'primitive types'
     		// Choose a random number within the range
-    		this->chromosome[mutated_index] = getRandomValue(this->chromosome[mutated_index]);
+    		this->chromosome[mutated_index] = getRandomValue(this->chromosome[mutated_index], engine);
     	}
     }
 
-    /**
-     * Generate a random chromosome.
-     */
-    void randChromosome() {
-		for(unsigned int i = 0; i < chromosome.size(); i++) {
-			chromosome[i] = getRandomValue();
-		}
-    }
-
     /**
      * Generate a random value for a chromosome element.
+     * @param engine The random number generator.
      * @return
      */
-    T getRandomValue() {
-    	return rand_value(random_engine);
+    T getRandomValue(std::mt19937 &engine) {
+    	std::uniform_int_distribution<int> dist(rand_value.param());
+    	return dist(engine);
     }
 
     /**
      * Generate a random value for the chromosome element that is not
-     * equal to the one provided.
+     * equal to the one provided. A value is drawn from the range without
+     * prev (one shorter) and moved past prev, so a single draw is needed.
      * @param prev The value for which the return will not be equal to.
+     * @param engine The random number generator.
      * @return The random value for the chromosome element that is not
-     * equal to prev.
+     * equal to prev, or prev if the range has a single value.
      */
-    T getRandomValue(T prev) {
-        T val = getRandomValue();
+    T getRandomValue(T prev, std::mt19937 &engine) {
+    	int min_value = rand_value.a();
+    	int max_value = rand_value.b();
+    	if(max_value <= min_value) {
+    		return prev;
+    	}
 
-        while(val == prev) {
-            val = getRandomValue();
-        }
-        return val;
+    	std::uniform_int_distribution<int> dist(min_value, max_value - 1);
+    	int val = dist(engine);
+    	if(val >= static_cast<int>(prev)) {
+    		val++;
+    	}
+    	return val;
     }
 };
 
 template<class T>
-std::mt19937 Chromosome<T >::random_engine;
+thread_local std::mt19937 Chromosome<T >::random_engine;
 template<class T>
-std::uniform_int_distribution<int > Chromosome<T >::rand_chrom_elem;
+thread_local std::uniform_int_distribution<int > Chromosome<T >::rand_chrom_elem;
 template<class T>
-std::uniform_int_distribution<int > Chromosome<T >::rand_value;
+thread_local std::uniform_int_distribution<int > Chromosome<T >::rand_value;
 
 #endif /* CHROMOSOME_HPP_ */
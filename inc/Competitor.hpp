@@ -26,34 +26,136 @@
 #define COMPETITOR_HPP_
 
 #include <vector>
+#include <limits>		// quiet_NaN
+#include <chrono>
+#include <algorithm>	// min, max, sort, push_heap, pop_heap
+#include <functional>	// greater
 
 #include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "Chromosome.hpp"
 #include "SafeQueue.hpp"
-#include "SafeVector.hpp"
+#include "EpochVector.hpp"
 
 #include <boost/thread/barrier.hpp>
 
+/**
+ * How a competitor adjusts its mutation and crossover rates between generations.
+ * NO_ADAPTATION keeps the initial rates for the whole run.
+ * SUCCESS_RULE applies the 1/5th success rule to the mutation rate, the
+ * mutation rate is decreased when more than a fifth of the offspring improve on
+ * their parent (the search is making progress) and increased when fewer do.
+ * DIVERSITY_ADAPTATION increases the mutation rate and decreases the crossover
+ * rate when the fitness diversity of the population drops below the target
+ * diversity, and the opposite when it is above.
+ * The adapted rates stay within ADAPTATION_RANGE times the initial rates.
+ */
+enum AdaptationMode {
+	NO_ADAPTATION,
+	SUCCESS_RULE,
+	DIVERSITY_ADAPTATION
+};
+
 template <class T>
 class Competitor {
 
 	unsigned int population_size;
-	double mutation_rate;
 
-	double crossover_rate;
+	// Read by the tiles of the cellular mode while the rates are adapted.
+	boost::atomic<double > mutation_rate;
+	boost::atomic<double > crossover_rate;
+
+	AdaptationMode adaptation;
+
+	// The NUMA node the competitor's threads run on when placement is enabled.
+	unsigned int node;
+
+	// The generation (high 32 bits) and number of chunks claimed in it (low 32 bits) in the
+	// pipelined mode. Tagging the count with the generation means it never has to be reset.
+	boost::atomic<unsigned long long > chunk_claims;
+
+	// The worker threads of the competitor wait on this while the evaluation is scheduled.
+	boost::scoped_ptr<boost::barrier> schedule_wall;
+	// The worker threads and the competitor's thread wait on this around the local search.
+	boost::scoped_ptr<boost::barrier> improve_wall;
+	unsigned int workers;
+
+	// The cost model of the scheduled evaluation: the mean seconds of an evaluation and the
+	// seconds per unit of the cost hint, both from the last evaluated generation.
+	double mean_cost;
+	double cost_scale;
+	bool cost_model_ready;
+
+	// The makespan of the evaluation of the last generation, predicted when it was
+	// scheduled and measured once every result was gathered.
+	double predicted_makespan;
+	double actual_makespan;
+	std::chrono::steady_clock::time_point schedule_time;
+
+	// The expected cost of each chunk and the load of each worker (a min heap) while
+	// the evaluation is scheduled, kept between generations.
+	std::vector<double > chunk_costs;
+	std::vector<double > worker_loads;
+
+	// The rates given by the user, adaptation keeps the rates within a band around them.
+	double initial_mutation_rate;
+	double initial_crossover_rate;
+
+	// The factor the rates are scaled by each generation.
+	static constexpr double ADAPTATION_FACTOR = 0.85;
+	static constexpr double SUCCESS_RATIO = 0.2;
+	// The coefficient of variation of the fitness targeted by diversity adaptation.
+	static constexpr double TARGET_DIVERSITY = 0.1;
+
+	// The rates can be adapted to at most this many times larger or smaller than the initial rates.
+	static constexpr double ADAPTATION_RANGE = 4.0;
 
 public:
 
-	SafeVector<Chromosome<T > > population;
+	// Read without locking, see EpochVector.
+	EpochVector<Chromosome<T > > population;
 	SafeQueue<Result > result_queue;
 
-	// This should not need to be a safe vector since access will be syncronized by other mechinsims
-	SafeVector<Result >fitness_results;
+	// The fitness of each chromosome by its index, gathered by the competitor's thread.
+	std::vector<double > fitness_values;
+
+	// The best chromosomes of the last generation, carried over untouched into the next generation.
+	std::vector<Chromosome<T > > elites;
+
+	// The fitness of the (best) parent of each chromosome, NaN for chromosomes without a parent.
+	// Each worker thread only writes the range of its own sub population.
+	std::vector<double > parent_fitness;
+
+	// Whether the fitness of each chromosome was predicted by the surrogate rather than evaluated.
+	// A char per chromosome since the worker threads write their ranges concurrently.
+	std::vector<char > predicted;
+
+	// The objectives of each chromosome in the multi-objective mode.
+	std::vector<std::vector<double > > objectives;
+
+	// The seconds each chromosome's evaluation took, the seconds it is expected to take
+	// (from its parents' costs or the cost hint, NaN when unknown) and its cost hint.
+	// Each worker thread only writes the range it evaluates or breeds.
+	std::vector<double > costs;
+	std::vector<double > expected_costs;
+	std::vector<double > cost_hints;
+
+	// The chunks of the population in the order they are evaluated, longest expected first.
+	std::vector<unsigned int > schedule;
+
+	// The best chromosomes of the generation the memetic mode improves, chosen by the
+	// competitor's thread, and the number claimed by the worker threads.
+	std::vector<unsigned int > improvement_targets;
+	boost::atomic<unsigned int > improvement_claims;
 
 	Competitor(unsigned int population_size, double mutation_rate, double
 		crossover_rate) : population_size(population_size),
-		mutation_rate(mutation_rate), crossover_rate(crossover_rate) {
+		mutation_rate(mutation_rate), crossover_rate(crossover_rate),
+		adaptation(NO_ADAPTATION), node(0), chunk_claims(0), workers(1), mean_cost(0), cost_scale(1),
+		cost_model_ready(false), predicted_makespan(0), actual_makespan(0), initial_mutation_rate(mutation_rate),
+		initial_crossover_rate(crossover_rate), improvement_claims(0) {
 	}
 
 	~Competitor() {
@@ -72,13 +174,259 @@ public:
 		return this->crossover_rate;
 	}
 
-	void initPopulation(unsigned int chromosome_size) {
-		std::vector<Chromosome<T > > pop;
-		Chromosome<T >::initPopulation(pop, this->population_size, chromosome_size);
-		this->population.push_back(pop);
+	/**
+	 * Set the rates given by the user, the current rates start from them.
+	 * @param mutation_rate The mutation rate.
+	 * @param crossover_rate The crossover rate.
+	 */
+	void setRates(double mutation_rate, double crossover_rate) {
+		this->mutation_rate = this->initial_mutation_rate = mutation_rate;
+		this->crossover_rate = this->initial_crossover_rate = crossover_rate;
 	}
 
+	void setAdaptation(AdaptationMode adaptation) {
+		this->adaptation = adaptation;
+	}
+
+	unsigned int getNode() {
+		return this->node;
+	}
+
+	void setNode(unsigned int node) {
+		this->node = node;
+	}
+
+	/**
+	 * Set the number of worker threads that evaluate the population.
+	 * @param workers The number of worker threads.
+	 */
+	void setWorkers(unsigned int workers) {
+		this->workers = workers;
+		this->schedule_wall.reset(new boost::barrier(workers));
+		this->improve_wall.reset(new boost::barrier(workers + 1));
+	}
+
+	boost::barrier &getScheduleWall() {
+		return *this->schedule_wall;
+	}
+
+	boost::barrier &getImproveWall() {
+		return *this->improve_wall;
+	}
+
+	double getMeanCost() {
+		return this->mean_cost;
+	}
+
+	double getCostScale() {
+		return this->cost_scale;
+	}
+
+	bool isCostModelReady() {
+		return this->cost_model_ready;
+	}
+
+	double getPredictedMakespan() {
+		return this->predicted_makespan;
+	}
+
+	double getActualMakespan() {
+		return this->actual_makespan;
+	}
+
+	/**
+	 * Create the storage for the population, the chromosomes are filled in by
+	 * each worker thread for its own range with initPopulation(start, ...).
+	 * The state the competitor kept from a previous run is reset.
+	 */
+	void initPopulation() {
+		this->population.resize(this->population_size);
+		this->parent_fitness.assign(this->population_size, std::numeric_limits<double >::quiet_NaN());
+		this->objectives.resize(this->population_size);
+		this->predicted.assign(this->population_size, false);
+		this->fitness_values.assign(this->population_size, 0);
+		this->costs.assign(this->population_size, 0);
+		this->expected_costs.assign(this->population_size, std::numeric_limits<double >::quiet_NaN());
+		this->cost_hints.assign(this->population_size, 0);
+		this->mean_cost = 0;
+		this->cost_scale = 1;
+		this->cost_model_ready = false;
+		this->predicted_makespan = 0;
+		this->actual_makespan = 0;
+		this->chunk_claims = 0;
+		this->mutation_rate = this->initial_mutation_rate;
+		this->crossover_rate = this->initial_crossover_rate;
+		this->elites.clear();
+	}
+
+	/**
+	 * Initialize a range of the population. The first seeded chromosomes of the
+	 * population are copies of the seeds, then made by the generator once the
+	 * seeds run out (if there is one), the rest are random. The chromosomes are
+	 * created in place by the calling thread.
+	 * @param start The start of the range.
+	 * @param count The size of the range.
+	 * @param chromosome_size The size of the chromosomes.
+	 * @param engine The random number generator of the calling thread.
+	 * @param seeds The chromosomes to start from.
+	 * @param seeded The number of chromosomes of the population that are seeded.
+	 * @param generator Creates a seeded chromosome in place, may be empty.
+	 */
+	void initPopulation(unsigned int start, unsigned int count, unsigned int chromosome_size,
+		std::mt19937 &engine, const std::vector<Chromosome<T > > &seeds, unsigned int seeded,
+		const boost::function<void (Chromosome<T > &, std::mt19937 &)> &generator) {
+		for(unsigned int i = start; i < start + count; i++) {
+			Chromosome<T > &chromosome = this->population.at(i);
+			if(i < seeded && i < seeds.size()) {
+				chromosome = seeds[i];
+				continue;
+			}
+
+			chromosome.resize(chromosome_size);
+			if(i < seeded && generator) {
+				generator(chromosome, engine);
+			} else {
+				chromosome.randChromosome(engine);
+			}
+		}
+	}
+
+	/**
+	 * Claim the next chunk of the population to work on in the pipelined mode.
+	 * @param generation The generation of the calling thread.
+	 * @param chunks The number of chunks in the population.
+	 * @return The chunk or -1 if every chunk of the generation has been claimed.
+	 */
+	int claimChunk(unsigned int generation, unsigned int chunks) {
+		unsigned long long current = chunk_claims;
+		while(true) {
+			unsigned int claimed_generation = current >> 32;
+			unsigned int claimed = claimed_generation == generation ? current & 0xffffffffu : 0;
+
+			// A later generation has started, the calling thread is behind.
+			if(claimed_generation > generation || claimed >= chunks) {
+				return -1;
+			}
+
+			unsigned long long next = (static_cast<unsigned long long >(generation) << 32) | (claimed + 1);
+			if(chunk_claims.compare_exchange_weak(current, next)) {
+				return claimed;
+			}
+		}
+	}
+
+	/**
+	 * Order the chunks of the population longest expected cost first (LPT), the
+	 * worker threads claim them in this order so the long evaluations start first
+	 * and the short ones fill in the gaps at the end of the generation. Called by
+	 * one worker thread once the expected costs of the generation are known.
+	 * @param chunk_size The number of chromosomes in a chunk.
+	 */
+	void scheduleChunks(unsigned int chunk_size) {
+		unsigned int chunks = (population_size + chunk_size - 1) / chunk_size;
+		chunk_costs.assign(chunks, 0);
+		for(unsigned int i = 0; i < population_size; i++) {
+			chunk_costs[i / chunk_size]+= expected_costs[i];
+		}
+
+		schedule.resize(chunks);
+		for(unsigned int i = 0; i < chunks; i++) {
+			schedule[i] = i;
+		}
+		// Ties keep the population order, std::stable_sort would allocate a buffer.
+		const std::vector<double > &costs = chunk_costs;
+		std::sort(schedule.begin(), schedule.end(), [&costs](unsigned int a, unsigned int b) {
+			return costs[a] > costs[b] || (costs[a] == costs[b] && a < b);
+		});
+
+		// Each chunk goes to the worker that becomes free first, as the claims do.
+		worker_loads.assign(workers, 0);
+		double makespan = 0;
+		for(unsigned int i = 0; i < chunks; i++) {
+			std::pop_heap(worker_loads.begin(), worker_loads.end(), std::greater<double >());
+			worker_loads.back()+= chunk_costs[schedule[i]];
+			makespan = std::max(makespan, worker_loads.back());
+			std::push_heap(worker_loads.begin(), worker_loads.end(), std::greater<double >());
+		}
+
+		predicted_makespan = cost_model_ready ? makespan : 0;
+		schedule_time = std::chrono::steady_clock::now();
+	}
+
+	/**
+	 * Update the cost model from the evaluation of the generation, called once every
+	 * result of the generation has been gathered.
+	 * @param hinted Whether the expected costs come from the cost hint.
+	 */
+	void updateCostModel(bool hinted) {
+		actual_makespan = std::chrono::duration<double >(std::chrono::steady_clock::now() - schedule_time).count();
+
+		double total = 0;
+		double total_hint = 0;
+		for(unsigned int i = 0; i < population_size; i++) {
+			total+= costs[i];
+			total_hint+= cost_hints[i];
+		}
+		mean_cost = total / population_size;
+		if(hinted && total_hint > 0) {
+			cost_scale = total / total_hint;
+		}
+		cost_model_ready = true;
+	}
+
+	/**
+	 * Adjust the mutation and crossover rates for the next generation.
+	 * @param success_ratio The fraction of the offspring that improved on their parent.
+	 * @param mean The mean fitness of the generation.
+	 * @param deviation The standard deviation of the fitness of the generation.
+	 */
+	void adapt(double success_ratio, double mean, double deviation) {
+
+		double mutation = mutation_rate;
+		double crossover = crossover_rate;
+		if(adaptation == SUCCESS_RULE) {
+			if(success_ratio > SUCCESS_RATIO) {
+				mutation*= ADAPTATION_FACTOR;
+			} else if(success_ratio < SUCCESS_RATIO) {
+				mutation/= ADAPTATION_FACTOR;
+			}
+		}
+		else if(adaptation == DIVERSITY_ADAPTATION && mean > 0) {
+			if(deviation / mean < TARGET_DIVERSITY) {
+				mutation/= ADAPTATION_FACTOR;
+				crossover*= ADAPTATION_FACTOR;
+			} else {
+				mutation*= ADAPTATION_FACTOR;
+				crossover/= ADAPTATION_FACTOR;
+			}
+		}
+
+		mutation_rate = bound(mutation, initial_mutation_rate);
+		crossover_rate = bound(crossover, initial_crossover_rate);
+	}
+
+
+private:
+
+	/**
+	 * Keep the rate within the adaptation range of the initial rate and within [0, 1].
+	 * @param rate The adapted rate.
+	 * @param initial_rate The rate given by the user.
+	 * @return The bounded rate.
+	 */
+	double bound(double rate, double initial_rate) {
+		rate = std::max(initial_rate / ADAPTATION_RANGE, rate);
+		return std::min(std::min(initial_rate * ADAPTATION_RANGE, 1.0), rate);
+	}
 };
 
+template<class T>
+constexpr double Competitor<T >::ADAPTATION_FACTOR;
+template<class T>
+constexpr double Competitor<T >::SUCCESS_RATIO;
+template<class T>
+constexpr double Competitor<T >::TARGET_DIVERSITY;
+template<class T>
+constexpr double Competitor<T >::ADAPTATION_RANGE;
 
 #endif /* COMPETITOR_HPP_ */
@@ -0,0 +1,122 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EPOCH_FLAGS_HPP_
+#define EPOCH_FLAGS_HPP_
+
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+/**
+ * A flag per thread holding the number of the epochs (e.g. generations) the
+ * thread has finished. A thread waits on the flags of the few threads it shares
+ * data with instead of a barrier over every thread, so threads that do not
+ * share data run at their own pace. The flags only ever increase, reading a
+ * flag acquires what its thread wrote before setting it.
+ */
+class EpochFlags {
+
+	boost::scoped_array<boost::atomic<unsigned int > > flags;
+	unsigned int count;
+	bool closed;
+
+	boost::mutex mtx_;
+	boost::condition_variable changed;
+
+public:
+
+	EpochFlags() : count(0), closed(false) {
+	}
+
+	~EpochFlags() {
+	}
+
+	/**
+	 * Set every flag to 0 and open the flags. Not thread safe.
+	 * @param count The number of flags.
+	 */
+	void reset(unsigned int count) {
+		if(count != this->count) {
+			flags.reset(new boost::atomic<unsigned int >[count]);
+			this->count = count;
+		}
+		for(unsigned int i = 0; i < count; i++) {
+			flags[i].store(0, boost::memory_order_relaxed);
+		}
+		closed = false;
+	}
+
+	/**
+	 * Get the epochs a flag's thread has finished.
+	 * @param flag The flag.
+	 */
+	unsigned int get(unsigned int flag) {
+		return flags[flag].load(boost::memory_order_acquire);
+	}
+
+	/**
+	 * Record that a flag's thread has finished an epoch and wake the threads waiting on it.
+	 * @param flag The flag.
+	 * @param epoch The number of epochs finished.
+	 */
+	void set(unsigned int flag, unsigned int epoch) {
+		flags[flag].store(epoch, boost::memory_order_release);
+
+		// Taking the lock means a waiter has either seen the epoch or is waiting to be woken.
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		changed.notify_all();
+	}
+
+	/**
+	 * Wait for a flag's thread to finish an epoch.
+	 * @param flag The flag.
+	 * @param epoch The number of epochs.
+	 * @return Whether the epoch was finished, false when the flags were closed first.
+	 */
+	bool wait(unsigned int flag, unsigned int epoch) {
+		if(get(flag) >= epoch) {
+			return true;
+		}
+
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		while(get(flag) < epoch && !closed) {
+			changed.wait(lock);
+		}
+		return get(flag) >= epoch;
+	}
+
+	/**
+	 * Wake every waiting thread up and make the waits return straight away, e.g.
+	 * once the threads are stopped and the epochs they wait for never come.
+	 */
+	void close() {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		closed = true;
+		changed.notify_all();
+	}
+};
+
+#endif /* EPOCH_FLAGS_HPP_ */
@@ -0,0 +1,124 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EPOCH_VECTOR_HPP_
+#define EPOCH_VECTOR_HPP_
+
+#include <vector>
+#include <algorithm>	// copy
+
+#include <boost/atomic.hpp>
+
+/**
+ * A population kept as two generations. The current generation is the one
+ * being bred and evaluated, each thread writes only its own range of it. The
+ * snapshot is the last published generation and is never written while it is
+ * the snapshot, so any thread can read it without locking. Publishing makes
+ * the current generation the snapshot and reuses the storage of the old
+ * snapshot for the next generation, the generations are told apart by an
+ * epoch counter.
+ *
+ * Publishing must not overlap with the threads using the vector, e.g. it is
+ * done while they wait on a barrier.
+ */
+template <typename T >
+class EpochVector {
+
+private:
+	std::vector<T > generations[2];
+	boost::atomic<unsigned int > epoch;
+
+public:
+
+	EpochVector() : epoch(0) {
+	}
+
+	~EpochVector() {
+	}
+
+	/**
+	 * Resize both generations. Not thread safe.
+	 * @param size The number of values in a generation.
+	 */
+	void resize(unsigned int size) {
+		generations[0].resize(size);
+		generations[1].resize(size);
+	}
+
+	unsigned int size() {
+		return generations[0].size();
+	}
+
+	/**
+	 * Get the number of generations that have been published.
+	 */
+	unsigned int getEpoch() {
+		return epoch.load(boost::memory_order_acquire);
+	}
+
+	/**
+	 * Get a value of the current generation.
+	 * @param index The index of the value.
+	 * @return The value.
+	 */
+	T& at(unsigned int index) {
+		return generations[getEpoch() & 1][index];
+	}
+
+	/**
+	 * Copy values over a range of the current generation.
+	 * @param offset The start of the range.
+	 * @param entries The values.
+	 */
+	void copy(unsigned int offset, std::vector<T > &entries) {
+		std::copy(entries.begin(), entries.end(), generations[getEpoch() & 1].begin() + offset);
+	}
+
+	/**
+	 * Get the current generation, e.g. to read the values of other threads that
+	 * are not being written without publishing them.
+	 * @return The generation, it changes with the next publish.
+	 */
+	const std::vector<T > &current() {
+		return generations[getEpoch() & 1];
+	}
+
+	/**
+	 * Get the last published generation.
+	 * @return The generation, it does not change until the next publish.
+	 */
+	const std::vector<T > &snapshot() {
+		return generations[(getEpoch() + 1) & 1];
+	}
+
+	/**
+	 * Publish the current generation as the snapshot. The next current generation
+	 * holds the values of the previous snapshot until they are overwritten.
+	 */
+	void publish() {
+		epoch.fetch_add(1, boost::memory_order_release);
+	}
+};
+
+#endif /* EPOCH_VECTOR_HPP_ */
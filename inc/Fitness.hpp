@@ -0,0 +1,113 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FITNESS_HPP_
+#define FITNESS_HPP_
+
+/**
+ * Reductions over a contiguous array of fitness values, fitness[i] belongs to
+ * chromosome i. Each reduction keeps FITNESS_LANES independent accumulators so
+ * the loop has no dependency between neighbouring elements and the compiler can
+ * keep the lanes in vector registers. The sums are added up in a different
+ * order to a plain loop so they may differ from it in the last bits.
+ */
+class Fitness {
+public:
+
+	static const unsigned int FITNESS_LANES = 4;
+
+	/**
+	 * The sum of the values.
+	 * @param values The values.
+	 * @param n The number of values.
+	 */
+	static double sum(const double *values, unsigned int n) {
+		double lanes[FITNESS_LANES] = {0, 0, 0, 0};
+		unsigned int i = 0;
+		for(; i + FITNESS_LANES <= n; i+= FITNESS_LANES) {
+			for(unsigned int l = 0; l < FITNESS_LANES; l++) {
+				lanes[l]+= values[i + l];
+			}
+		}
+		for(; i < n; i++) {
+			lanes[0]+= values[i];
+		}
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+
+	/**
+	 * The mean of the values, 0 when there are none.
+	 * @param values The values.
+	 * @param n The number of values.
+	 */
+	static double mean(const double *values, unsigned int n) {
+		return n > 0 ? sum(values, n) / n : 0;
+	}
+
+	/**
+	 * The largest value, n must be at least 1.
+	 * @param values The values.
+	 * @param n The number of values.
+	 */
+	static double max(const double *values, unsigned int n) {
+		double lanes[FITNESS_LANES] = {values[0], values[0], values[0], values[0]};
+		unsigned int i = 0;
+		for(; i + FITNESS_LANES <= n; i+= FITNESS_LANES) {
+			for(unsigned int l = 0; l < FITNESS_LANES; l++) {
+				lanes[l] = values[i + l] > lanes[l] ? values[i + l] : lanes[l];
+			}
+		}
+		for(; i < n; i++) {
+			lanes[0] = values[i] > lanes[0] ? values[i] : lanes[0];
+		}
+		double a = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+		double b = lanes[2] > lanes[3] ? lanes[2] : lanes[3];
+		return a > b ? a : b;
+	}
+
+	/**
+	 * The sum of the squared differences from the mean (n times the variance),
+	 * the second pass of the two pass variance.
+	 * @param values The values.
+	 * @param n The number of values.
+	 * @param mean The mean of the values.
+	 */
+	static double squaredDeviations(const double *values, unsigned int n, double mean) {
+		double lanes[FITNESS_LANES] = {0, 0, 0, 0};
+		unsigned int i = 0;
+		for(; i + FITNESS_LANES <= n; i+= FITNESS_LANES) {
+			for(unsigned int l = 0; l < FITNESS_LANES; l++) {
+				double delta = values[i + l] - mean;
+				lanes[l]+= delta * delta;
+			}
+		}
+		for(; i < n; i++) {
+			double delta = values[i] - mean;
+			lanes[0]+= delta * delta;
+		}
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+};
+
+#endif /* FITNESS_HPP_ */
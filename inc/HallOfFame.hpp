@@ -0,0 +1,154 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HALL_OF_FAME_HPP_
+#define HALL_OF_FAME_HPP_
+
+#include <vector>
+#include <utility>
+
+#include <boost/thread/mutex.hpp>
+
+#include "Chromosome.hpp"
+#include "Arena.hpp"
+
+/**
+ * A bounded collection of the best distinct chromosomes found during the run.
+ * The entries are kept sorted from the best fitness to the worst so the
+ * candidate can be rejected against the worst entry without a search.
+ */
+template <class T>
+class HallOfFame {
+
+private:
+	unsigned int capacity;
+	std::vector<std::pair<double, Chromosome<T > > > entries;
+	boost::mutex mtx_;
+
+public:
+
+	/**
+	 * Create a hall of fame.
+	 * @param capacity The maximum number of chromosomes kept.
+	 */
+	HallOfFame(unsigned int capacity=10) : capacity(capacity) {
+	}
+
+	~HallOfFame() {
+	}
+
+	/**
+	 * Change the maximum number of chromosomes kept, the worst entries are
+	 * dropped if there are more than the new capacity.
+	 * @param capacity The maximum number of chromosomes kept.
+	 */
+	void setCapacity(unsigned int capacity) {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		this->capacity = capacity;
+		if(entries.size() > capacity) {
+			entries.resize(capacity);
+		}
+	}
+
+	unsigned int getCapacity() {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		return capacity;
+	}
+
+	unsigned int size() {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		return entries.size();
+	}
+
+	void clear() {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		entries.clear();
+	}
+
+	/**
+	 * Get the best fitness within the hall of fame.
+	 * @return The best fitness or 0 if the hall of fame is empty.
+	 */
+	double best() {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		if(entries.empty()) {
+			return 0;
+		}
+		return entries.front().first;
+	}
+
+	/**
+	 * Offer a chromosome to the hall of fame. The chromosome is only added if
+	 * it is better than the worst entry (or there is room) and it is not
+	 * already within the hall of fame.
+	 * @param chromosome The candidate chromosome.
+	 * @param fitness The fitness of the candidate.
+	 * @return Whether the chromosome was added.
+	 */
+	bool add(Chromosome<T > &chromosome, double fitness) {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+
+		// The entries outlive the generation so they are kept on the heap.
+		ArenaScope heap(NULL);
+
+		if(capacity == 0 || (entries.size() == capacity && fitness <= entries.back().first)) {
+			return false;
+		}
+
+		// The capacity is expected to be small so a linear search for duplicates is enough.
+		unsigned int position = entries.size();
+		for(unsigned int i = 0; i < entries.size(); i++) {
+			if(entries[i].second == chromosome) {
+				return false;
+			}
+			if(position == entries.size() && fitness > entries[i].first) {
+				position = i;
+			}
+		}
+
+		entries.insert(entries.begin() + position, std::make_pair(fitness, chromosome));
+		if(entries.size() > capacity) {
+			entries.pop_back();
+		}
+		return true;
+	}
+
+	/**
+	 * Retrieve a copy of the hall of fame, ordered from best to worst.
+	 * @param chromosomes The output chromosomes.
+	 * @param fitness The output fitness of each chromosome.
+	 */
+	void getAll(std::vector<Chromosome<T > > &chromosomes, std::vector<double > &fitness) {
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		chromosomes.clear();
+		fitness.clear();
+		for(unsigned int i = 0; i < entries.size(); i++) {
+			fitness.push_back(entries[i].first);
+			chromosomes.push_back(entries[i].second);
+		}
+	}
+};
+
+
+#endif /* HALL_OF_FAME_HPP_ */
@@ -0,0 +1,104 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LATENCY_SERVICE_HPP_
+#define LATENCY_SERVICE_HPP_
+
+#include <queue>
+#include <vector>
+#include <future>
+#include <chrono>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+/**
+ * A stand-in for a remote fitness service: each request is answered after a
+ * fixed latency by one of a few service threads, so thousands of requests can
+ * be in flight while the service only has a handful of threads. Requests are
+ * answered in the order they become due. Used by the asynchronous fitness demo
+ * and its test.
+ */
+class LatencyService {
+
+	struct Request {
+		std::chrono::steady_clock::time_point due;
+		unsigned long long sequence;
+		boost::function<double ()> evaluate;
+		boost::shared_ptr<std::promise<double > > promise;
+	};
+
+	// Orders the queue soonest due first.
+	struct Later {
+		bool operator()(const Request &a, const Request &b) const {
+			return a.due > b.due || (a.due == b.due && a.sequence > b.sequence);
+		}
+	};
+
+	std::chrono::steady_clock::duration latency;
+	std::priority_queue<Request, std::vector<Request >, Later > requests;
+	unsigned long long sequence;
+	unsigned int max_pending;
+	bool stopping;
+
+	boost::mutex mtx_;
+	boost::condition_variable changed;
+	boost::thread_group threads;
+
+public:
+
+	/**
+	 * Start the service threads.
+	 * @param num_threads The number of service threads.
+	 * @param latency The seconds before a request is answered.
+	 */
+	LatencyService(unsigned int num_threads, double latency);
+
+	/**
+	 * Stop the service threads, requests that have not been answered are broken.
+	 */
+	~LatencyService();
+
+	/**
+	 * Send a request to the service.
+	 * @param evaluate Computes the answer on a service thread once the request is
+	 * due, an exception it throws is given to the future.
+	 * @return The answer.
+	 */
+	std::future<double > submit(boost::function<double ()> evaluate);
+
+	/**
+	 * Get the most requests that were waiting for an answer at once.
+	 */
+	unsigned int getMaxPending();
+
+private:
+
+	void work();
+};
+
+#endif /* LATENCY_SERVICE_HPP_ */
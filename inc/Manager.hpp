@@ -29,19 +29,58 @@
 #include <random>            // mt19937, uniform_int_distribution, random_device
 
 #include <utility>			 // make_pair
+#include <algorithm>		 // nth_element, max, min
+#include <cmath>			 // sqrt
+#include <chrono>			 // steady_clock
+#include <unordered_map>	 // unordered_multimap
+#include <future>			 // future
+#include <deque>
 
 #include <boost/thread/thread.hpp>
 #include <boost/thread/barrier.hpp>
 #include <boost/atomic.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
 
 #include "Chromosome.hpp"
 #include "RouletteWheel.hpp"
 #include "Result.hpp"
+#include "Fitness.hpp"
+#include "Termination.hpp"
+#include "Pareto.hpp"
+#include "Arena.hpp"
+#include "ProcessPool.hpp"
+#include "Topology.hpp"
+#include "PerfCounters.hpp"
 
 #include "Competitor.hpp"
+#include "HallOfFame.hpp"
+#include "SolutionSet.hpp"
+#include "Surrogate.hpp"
 #include "SafeQueue.hpp"
-#include "SafeVector.hpp"
+#include "EpochFlags.hpp"
+
+/**
+ * What the mutation rate of a competitor is the probability of.
+ * CHROMOSOME_MUTATION mutates a single element of an offspring with the rate,
+ * GENE_MUTATION mutates each element of every offspring with the rate.
+ */
+enum MutationMode {
+	CHROMOSOME_MUTATION,
+	GENE_MUTATION
+};
+
+/**
+ * What happens to a chromosome improved by the local search of the memetic mode.
+ * LAMARCKIAN replaces the chromosome with the improved one, BALDWINIAN keeps the
+ * chromosome and only gives it the fitness of the improved one. An improved
+ * chromosome that is a solution always replaces the chromosome so the solution is kept.
+ */
+enum WriteBack {
+	LAMARCKIAN,
+	BALDWINIAN
+};
 
 template <class T>
 class Manager {
@@ -54,24 +93,72 @@ protected:
 	T max_chromosome_value;
 	T min_chromosome_value;
 
-	SafeVector<Chromosome<T > > master_population;
+	// The fitness of each chromosome of the master population by its index.
+	std::vector<double > master_values;
+
+	unsigned long long allocation_count;
+
+	// The master population is merged by the worker threads, each working on a slice.
+	// The sums of the slices give each worker the offset of its part of the selection table.
+	struct SliceSummary {
+		double sum;
+		unsigned int n;
+		double mean;
+		double m2;
+		double best;
+	};
+	std::vector<SliceSummary > slice_summaries;
+
+	// The start of each competitor's range in the master population.
+	std::vector<unsigned int > competitor_offsets;
+
+	// The distinct chromosomes found with a fitness of 1.0
+	SolutionSet<T> solutions;
+
+	// The best distinct chromosomes found
+	HallOfFame<T> hall_of_fame;
+
+	// The chromosomes the initial populations are seeded with, see setSeeds.
+	std::vector<Chromosome<T > > seeds;
+	boost::function<void (Chromosome<T > &, std::mt19937 &)> generator;
+	double seed_fraction;
+
+	// The non-dominated chromosomes found by the multi-objective mode and their objectives
+	std::vector<Chromosome<T > > pareto_front;
+	std::vector<std::vector<double > > pareto_objectives;
+	unsigned int max_pareto_size;
+
+	// The objectives of each chromosome of the master population by its index (multi-objective mode)
+	std::vector<std::vector<double > > master_objectives;
 
-	std::vector<Result > master_fitness;
+	// The indexes of the master population ordered lexicographically by their objectives,
+	// each slice is ordered by its worker thread in merge() (multi-objective mode)
+	std::vector<unsigned int > pareto_order;
 
-	// Need to have some way of ensure no duplication of solutions
-	SafeVector<Chromosome<T> > solutions;
+	// The number of the best chromosomes of each competitor copied into the next generation.
+	unsigned int elitism;
+
+	MutationMode mutation_mode;
+	CrossoverType crossover_type;
 
 	RouletteWheel rw;
 
 	boost::thread_group fitness_group;
 
-	std::mt19937 rand_engine;
+	// Each worker thread seeds its own engine from the seed and its stream number.
+	unsigned int seed;
 	std::uniform_real_distribution<float> op_dist;
 	std::uniform_real_distribution<float> mutation_dist;
 
+	// When the last worker finished initializing its part of the population (steady clock ns).
+	boost::atomic<long long> initialized_time;
+
 	unsigned int max_num_threads;
 
 	boost::atomic<bool> done;
+
+	// Set when the Manager is destroyed, the threads parked between runs then exit.
+	boost::atomic<bool> closing;
 	
 	unsigned int num_competitor;
 	std::vector<boost::shared_ptr<Competitor<T > > > competitors;
@@ -79,13 +166,161 @@ protected:
 	boost::thread_group competitor_group;
 	boost::barrier wall;
 	boost::barrier whistle;
+	// The worker threads and the referee, used for the phases of the merge.
+	boost::barrier merge_wall;
+
+	// Criteria checked after every generation, any one of them can stop the run.
+	std::vector<boost::shared_ptr<TerminationCriteria > > termination_criteria;
+	GenerationStatistics statistics;
+
+	// Called by the referee with the statistics of each generation.
+	boost::function<void (const GenerationStatistics &)> progress;
+
+	// Sets up the state of the problem kept per thread, called by every thread of a run.
+	boost::function<void ()> thread_setup;
+	std::chrono::steady_clock::time_point start_time;
 
 	// Fitness function
 	double (*fitness_function)(Chromosome<T>);
+
+	// Objective function, used instead of the fitness function by the multi-objective mode
+	std::vector<double > (*objective_function)(Chromosome<T>);
+
+	// Asynchronous fitness function, used instead of the fitness function for fitness
+	// functions that mostly wait (e.g. on a service).
+	std::future<double > (*async_function)(Chromosome<T>);
+
+	// Predicts the fitness of the offspring so only the most promising fraction is evaluated,
+	// the surrogate is not used when the fraction is 0.
+	Surrogate<T > surrogate;
+	double surrogate_fraction;
+	unsigned long long surrogate_predictions;
+
+	// Each competitor is placed on a NUMA node when enabled, its threads are pinned to the
+	// node so the chromosomes they initialize and breed are allocated on the node.
+	Topology topology;
+	bool numa_placement;
+
+	// The size of the chunks the worker threads claim in the pipelined mode, 0 when the
+	// worker threads each evaluate and breed a fixed range of the population.
+	unsigned int pipeline_chunk_size;
+
+	// The worker threads of each competitor that claim chunks in the pipelined mode, the
+	// others only take part in the merge. Only fewer than all of them while autotuning.
+	unsigned int active_threads;
+
+	// The generations each configuration of the pipelined mode is timed for by the
+	// autotuning, 0 when the run is not tuned.
+	unsigned int autotune_generations;
+
+	// A configuration of the pipelined mode tried by the autotuning.
+	struct TuneConfiguration {
+		unsigned int threads;
+		unsigned int chunk_size;
+	};
+
+	// The configurations left to try (the one running is the first), when the current
+	// one started (in seconds and evaluations since the start of the run) and the
+	// fastest so far with its evaluations per second.
+	std::vector<TuneConfiguration > tune_configurations;
+	double tune_start_time;
+	unsigned long long tune_start_evaluations;
+	TuneConfiguration tuned;
+	double tuned_rate;
+
+public:
+	/**
+	 * A local search of the memetic mode, improves a chromosome in place.
+	 * @param chromosome The chromosome.
+	 * @param fitness The fitness of the chromosome, updated to the fitness of the improved chromosome.
+	 * @param budget The maximum number of fitness evaluations to use.
+	 * @param engine The random number generator of the calling thread.
+	 * @return The number of fitness evaluations used.
+	 */
+	typedef boost::function<unsigned int (Chromosome<T > &chromosome, double &fitness, unsigned int budget,
+		std::mt19937 &engine)> LocalSearch;
+
+protected:
+
+	// Applied to the best chromosomes of each competitor after they are evaluated,
+	// the memetic mode is off when the count is 0.
+	LocalSearch local_search;
+	unsigned int local_search_count;
+	unsigned int local_search_budget;
+	WriteBack write_back;
+	boost::atomic<unsigned long long > local_search_evaluations;
+
+	// In the cellular mode each competitor's population is a toroidal grid of the
+	// width and the parents of a chromosome are taken from the cells around it.
+	bool cellular;
+	unsigned int grid_width;
+
+	// What the tile of a worker thread reports of each generation in the cellular mode.
+	struct TileReport {
+		SliceSummary summary;
+		unsigned int evaluations;
+		unsigned int compared;
+		unsigned int successes;
+	};
+
+	// The reports of the last generations of every tile, a window of generations by the
+	// tile (the number of the worker thread). A tile can be at most the window ahead of
+	// the statistics, so the report it replaces has been read.
+	std::vector<TileReport > tile_reports;
+	static const unsigned int TILE_WINDOW = 8;
+
+	// The generations each tile has evaluated and bred from, and the generations the
+	// statistics have been gathered for (a single flag).
+	EpochFlags tile_evaluated;
+	EpochFlags tile_bred;
+	EpochFlags tile_reduced;
+
+	// The size of the chunks the evaluation is scheduled in, 0 when each worker thread
+	// evaluates its own range. The cost hint gives the relative cost of a chromosome.
+	unsigned int schedule_chunk_size;
+	boost::function<double (const Chromosome<T > &)> cost_hint;
+
+	// The seconds the evaluation of each chromosome of the master population took.
+	std::vector<double > master_costs;
+
+	// The hardware events of each phase of the generations, summed over the threads
+	// as they finish, and the events that could be counted (a bit per CounterEvent).
+	bool perf_counters;
+	boost::mutex counter_mutex;
+	PhaseCounts phase_counts[NUM_GENERATION_PHASES];
+	unsigned int counter_events;
+
+	// The buffers each worker thread keeps between generations for the evaluation.
+	struct EvaluationBuffers {
+		// The chromosomes and their fitness exchanged with the worker processes.
+		std::vector<T > genes;
+		std::vector<double > outputs;
+		// The predicted fitness and the order of the range when the surrogate is used.
+		std::vector<double > predictions;
+		std::vector<unsigned int > order;
+	};
+
+	// The limit on the asynchronous evaluations in flight across all the worker threads.
+	unsigned int max_in_flight;
+	boost::atomic<unsigned int > in_flight;
+
+	// The fitness is evaluated by worker processes when there are any, created for each run.
+	unsigned int process_workers;
+	unsigned int process_batch_size;
+	boost::shared_ptr<ProcessPool > process_pool;
+	unsigned long long process_restarts;
+	unsigned long long process_failures;
+
+	// The number of objectives returned by the objective function, used for the chromosomes
+	// that could not be evaluated by the worker processes.
+	boost::atomic<unsigned int > num_objectives;
+
+	// The most objectives a worker process can return for a chromosome.
+	static const unsigned int MAX_OBJECTIVES = 15;
 public:
 
 	/**
-	 * Create a non self-adaptive GA manager
+	 * Create a GA manager, the rates are fixed unless an adaptation mode is set
 	 * @param population_sizes The size of population.
 	 * @param chromosome_size The size of each chromosome.
 	 * @param max_chromosome_value The maximum possible value for the chromosome.
@@ -103,338 +338,2375 @@ public:
 				std::vector<double > crossover_rates, unsigned int num_competitor, unsigned int num_threads) :
 				chromosome_size(chromosome_size), max_generation_number(max_generation_number),
 				max_chromosome_value(max_chromosome_value), min_chromosome_value(min_chromosome_value),
-				num_competitor(num_competitor), max_num_threads(num_threads),
-				wall(num_competitor*num_threads + num_competitor + 1), whistle(num_competitor+1) {
+				max_pareto_size(100), elitism(0), max_num_threads(num_threads), num_competitor(num_competitor),
+				wall(num_competitor*num_threads + num_competitor + 1), whistle(num_competitor+1),
+				merge_wall(num_competitor*num_threads + 1), surrogate_fraction(0), surrogate_predictions(0),
+				numa_placement(false), pipeline_chunk_size(0), active_threads(num_threads), autotune_generations(0),
+				tune_start_time(0), tune_start_evaluations(0), tuned(), tuned_rate(0), local_search_count(0),
+				local_search_budget(0), write_back(LAMARCKIAN), local_search_evaluations(0), cellular(false), grid_width(0),
+				schedule_chunk_size(0), perf_counters(false), counter_events(0), max_in_flight(1024),
+				in_flight(0), process_workers(0), process_batch_size(64), process_restarts(0),
+				process_failures(0), num_objectives(0) {
 				
 		initialize(population_sizes, mutation_rates, crossover_rates); 
 
 	}
 
 	~Manager() {
+		// Wake the parked threads up to exit.
+		closing = true;
+		wall.wait();
+		fitness_group.join_all();
+		competitor_group.join_all();
+	}
+
+	/**
+	 * Restore the settings of a new Manager, so the Manager and its threads can be
+	 * reused for another problem of the same shape (the population sizes, chromosome
+	 * size and range, competitors and threads) instead of creating a new one. What
+	 * the last run found is kept until the next run starts.
+	 * @param max_generation_number The maximum number of generations of the next run.
+	 * @param mutation_rates The mutation rate of each competitor.
+	 * @param crossover_rates The crossover rate of each competitor.
+	 */
+	void reset(unsigned int max_generation_number, std::vector<double > mutation_rates,
+		std::vector<double > crossover_rates) {
+		std::random_device rd;
+		this->max_generation_number = max_generation_number;
+		seed = rd();
+		termination_criteria.clear();
+		progress.clear();
+		thread_setup.clear();
+		fitness_function = NULL;
+		objective_function = NULL;
+		async_function = NULL;
+		elitism = 0;
+		mutation_mode = CHROMOSOME_MUTATION;
+		crossover_type = ONE_POINT;
+		hall_of_fame.setCapacity(10);
+		solutions.setCapacity(1000);
+		max_pareto_size = 100;
+		seeds.clear();
+		generator.clear();
+		seed_fraction = 1.0;
+		process_workers = 0;
+		process_batch_size = 64;
+		max_in_flight = 1024;
+		setSurrogate(0);
+		numa_placement = false;
+		pipeline_chunk_size = 0;
+		autotune_generations = 0;
+		setLocalSearch(LocalSearch(), 0, 0);
+		setCellular(false);
+		setCostScheduling(0);
+		perf_counters = false;
 
+		for(unsigned int i = 0; i < competitors.size(); i++) {
+			competitors[i]->setRates(mutation_rates[i], crossover_rates[i]);
+			competitors[i]->setAdaptation(NO_ADAPTATION);
+		}
 	}
 
-    /**
-	 * Run the algorithm for the specified number of generations
-	 */	
-	unsigned int run(double (*fitness_function)(Chromosome<T>)) {
+	/**
+	 * Add a criteria that is checked after each generation. The run stops when
+	 * the maximum number of generations is reached, a solution is found or any
+	 * of the criteria is met.
+	 * @param criteria The termination criteria to add.
+	 */
+	void addTerminationCriteria(boost::shared_ptr<TerminationCriteria > criteria) {
+		termination_criteria.push_back(criteria);
+	}
 
+	/**
+	 * Set a function that is given the statistics of each generation once they
+	 * are gathered. It is called by the referee while the worker threads wait,
+	 * so it should return quickly.
+	 * @param progress The function, empty to remove it.
+	 */
+	void setProgress(boost::function<void (const GenerationStatistics &)> progress) {
+		this->progress = progress;
+	}
 
-		for(unsigned int i = 0; i < num_competitor; i++) {
-			competitors[i]->initPopulation(this->chromosome_size);
-
-			/*
-			std::cout << "Initial Population " << std::endl;
-			std::vector<Chromosome<T > > initial_pop;
-			competitors[i]->population.getAll(initial_pop);
-			for (unsigned int i = 0; i < initial_pop.size(); i++) {
-				for (unsigned int j = 0; j < chromosome_size; j++) {
-					std::cout << initial_pop[i][j];
-					if(j +1 < chromosome_size) {
-						std::cout << ",";
-					}
-				}
-				std::cout << '\n';
+	/**
+	 * Set a function that sets up the state of the problem a thread needs that is
+	 * kept per thread, e.g. Program::setup. It is called by each thread of the
+	 * Manager at the start of a run, after the range of the chromosomes is set up.
+	 * @param setup The function, empty to remove it.
+	 */
+	void setThreadSetup(boost::function<void ()> setup) {
+		this->thread_setup = setup;
+	}
 
-			}*/
-		}
-		this->fitness_function = fitness_function;
-		wall.wait();
-		unsigned int i;
-		for(i = 0; i < max_generation_number && !done; i++) {
-		//for(unsigned int i = 0; i < 1; i++) {
-			//std::cout << "Generation " << i << std::endl;
+	/**
+	 * Set the number of the best chromosomes of each competitor that are copied
+	 * untouched into the next generation.
+	 * @param elitism The number of elite chromosomes per competitor.
+	 */
+	void setElitism(unsigned int elitism) {
+		this->elitism = elitism;
+	}
 
-			// On the last generation
-			if(i+1 == max_generation_number) {
-			//if(i+1 == 1) {
-				referee(true);
-			}
-			else {
-				referee();
-			}
-			//runGeneration();
-			
+	/**
+	 * Set how every competitor adapts its mutation and crossover rates.
+	 * @param adaptation The adaptation mode.
+	 */
+	void setAdaptation(AdaptationMode adaptation) {
+		for(unsigned int i = 0; i < competitors.size(); i++) {
+			competitors[i]->setAdaptation(adaptation);
 		}
+	}
 
-		done = true;
+	/**
+	 * Set what the mutation rates are the probability of, see MutationMode.
+	 * @param mode The mutation mode, CHROMOSOME_MUTATION by default.
+	 */
+	void setMutationMode(MutationMode mode) {
+		this->mutation_mode = mode;
+	}
 
-		fitness_group.join_all();
+	/**
+	 * Set how the parents are crossed over.
+	 * @param type The crossover type, ONE_POINT by default.
+	 */
+	void setCrossoverType(CrossoverType type) {
+		this->crossover_type = type;
+	}
 
-		/*
-		for(unsigned int i = 0; i < num_competitor; i++) {
+	/**
+	 * Get the current rates of each competitor.
+	 * @param mutation_rates The output mutation rate of each competitor.
+	 * @param crossover_rates The output crossover rate of each competitor.
+	 */
+	void getRates(std::vector<double > &mutation_rates, std::vector<double > &crossover_rates) {
+		mutation_rates.clear();
+		crossover_rates.clear();
+		for(unsigned int i = 0; i < competitors.size(); i++) {
+			mutation_rates.push_back(competitors[i]->getMutationRate());
+			crossover_rates.push_back(competitors[i]->getCrossoverRate());
+		}
+	}
 
-			std::cout << "Result Population: " << std::endl;
-			std::vector<Chromosome<T > > final_pop;
-			competitors[i]->population.getAll(final_pop);
-			for (unsigned int i = 0; i < final_pop.size(); i++) {
-				for (unsigned int j = 0; j < chromosome_size; j++) {
-					std::cout << final_pop[i][j];
-					if(j +1 < chromosome_size) {
-						std::cout << ",";
-					}
-				}
-				std::cout << '\n';
+	/**
+	 * Set the seed used for the random number generator of each worker thread.
+	 * Each worker uses an independent stream derived from the seed.
+	 * @param seed The seed.
+	 */
+	void setSeed(unsigned int seed) {
+		this->seed = seed;
+	}
 
-			}
-		}*/
-		return i;
+	/**
+	 * Evaluate the fitness function in forked worker processes instead of the
+	 * worker threads. This isolates fitness functions that are not thread safe
+	 * or may crash, a crashed worker process is restarted and its batch is
+	 * evaluated again. Chromosomes that keep crashing their worker get a fitness of 0.
+	 * The workers are forked at the start of each run, no threads other than the
+	 * Manager's may be running then (see ProcessPool).
+	 * @param processes The number of worker processes, 0 evaluates in the worker threads.
+	 * @param batch_size The number of chromosomes given to a worker process at once.
+	 */
+	void setProcessWorkers(unsigned int processes, unsigned int batch_size=64) {
+		this->process_workers = processes;
+		this->process_batch_size = batch_size;
 	}
 
 	/**
-	 * Get another chromosome and apply the fitness function.
-	 * @param m The manager the thread is running for.
-	 * TODO finish the documentation
+	 * Pre-screen the offspring with a k nearest neighbour surrogate of the fitness
+	 * function. Only the fraction of each worker's range with the best predicted
+	 * fitness is evaluated, the rest keep their predicted fitness. Chromosomes
+	 * predicted to be solutions are always evaluated. Only used with a (synchronous)
+	 * single objective fitness function evaluated by the worker threads, and only
+	 * with fixed size chromosomes.
+	 * @param fraction The fraction of the offspring evaluated, 0 disables the surrogate.
+	 * @param neighbours The number of neighbours used for a prediction.
+	 * @param archive_size The number of evaluated chromosomes the surrogate is trained on.
 	 */
-	static void calcFitnessFunction(Manager *m, boost::shared_ptr<Competitor<T > > comp,
-		unsigned int start_index, unsigned int problem_size) {
+	void setSurrogate(double fraction, unsigned int neighbours=5, unsigned int archive_size=2000) {
+		this->surrogate_fraction = std::min(std::max(fraction, 0.0), 1.0);
+		this->surrogate.setup(archive_size, neighbours);
+	}
 
-		//std::cout << "Worker Thread range " << start_index << " - " << start_index+problem_size << std::endl;
+	/**
+	 * Run a memetic algorithm, the best chromosomes of each competitor are improved
+	 * by a local search every generation once they are evaluated. The competitor's
+	 * thread picks the best count chromosomes of the whole generation and the worker
+	 * threads share them out, the evaluations the search uses are counted in the
+	 * statistics. Only used with a single objective fitness function.
+	 * @param search The local search, e.g. one that knows the problem.
+	 * @param count The number of the best chromosomes of each competitor improved each generation, 0 disables it.
+	 * @param budget The fitness evaluations given to each chromosome.
+	 * @param write_back Whether the improved chromosomes replace the originals.
+	 */
+	void setLocalSearch(LocalSearch search, unsigned int count, unsigned int budget,
+		WriteBack write_back=LAMARCKIAN) {
+		this->local_search = search;
+		this->local_search_count = count;
+		this->local_search_budget = budget;
+		this->write_back = write_back;
+	}
 
-		unsigned int problem_index;
-		std::vector<Result > results;
+	/**
+	 * Use hill climbing as the local search of the memetic mode, the chromosome is
+	 * replaced by a mutation of it whenever the mutation is at least as fit. The
+	 * mutations are evaluated like the population, by the worker processes or the
+	 * asynchronous fitness when either is used.
+	 * @param count The number of the best chromosomes of each competitor improved each generation.
+	 * @param budget The fitness evaluations given to each chromosome.
+	 * @param write_back Whether the improved chromosomes replace the originals.
+	 */
+	void setHillClimbing(unsigned int count, unsigned int budget, WriteBack write_back=LAMARCKIAN) {
+		setLocalSearch(boost::bind(&Manager::hillClimb, this, _1, _2, _3, _4), count, budget, write_back);
+	}
 
-		m->wall.wait();
+	/**
+	 * Run a cellular (diffusion) genetic algorithm. Each competitor's population
+	 * is a toroidal grid, row after row, and a chromosome is replaced by the
+	 * offspring of itself and the fitter of two random cells of its von Neumann
+	 * neighbourhood (the cells above, below, left and right). Each worker thread
+	 * evaluates and breeds its own tile of rows, reading the rows beyond its tile
+	 * (the halo) from the tiles next to it. There is no barrier over every thread:
+	 * a tile only waits for the tiles next to it to evaluate a generation before
+	 * breeding from it and to breed from it before overwriting it, so the tiles
+	 * run at their own pace. The statistics and termination are gathered from the
+	 * reports of the tiles as they come in, the run stops once they are met and
+	 * tiles that ran ahead stop at their next generation. The elitism keeps the
+	 * best chromosomes of each tile and the rates are adapted from the reports of
+	 * the competitor's tiles. Only used with a single objective fitness function,
+	 * the pipelined mode, cost scheduling and the memetic mode are not used.
+	 * @param cellular Whether the cellular mode is used.
+	 * @param width The width of the grid, 0 for the square root of the population size.
+	 */
+	void setCellular(bool cellular, unsigned int width=0) {
+		this->cellular = cellular;
+		this->grid_width = width;
+	}
 
-		while(!m->done) {
+	/**
+	 * Schedule the evaluation by its expected cost. Each evaluation is timed and the
+	 * expected cost of a chromosome is the mean cost of its parents (or the mean cost
+	 * of the last generation when it has none), or the cost hint scaled to seconds by
+	 * the last generation when a hint is given. Once bred, the population is split into
+	 * chunks which the worker threads claim longest expected first, rather than each
+	 * evaluating its own range. The predicted and actual makespan of the evaluation
+	 * are added to the statistics. Not used in the pipelined mode.
+	 * @param chunk_size The number of chromosomes in a chunk, 0 disables the scheduling.
+	 * @param hint Gives the relative cost of evaluating a chromosome, may be empty.
+	 */
+	void setCostScheduling(unsigned int chunk_size,
+		boost::function<double (const Chromosome<T > &)> hint=boost::function<double (const Chromosome<T > &)>()) {
+		this->schedule_chunk_size = chunk_size;
+		this->cost_hint = hint;
+	}
 
-			// Could have a look up table (cache) of recent solutions but this is most likely a completely alternative idea
+	/**
+	 * Count the hardware events (cycles, instructions, LLC misses and branch misses)
+	 * of the evaluation, selection, breeding and referee phases of the generations
+	 * on each thread. Events the machine can not count are left out.
+	 * @param perf_counters Whether the hardware events are counted.
+	 */
+	void setPerfCounters(bool perf_counters) {
+		this->perf_counters = perf_counters;
+	}
 
-			// Can we trust the user to not change the chromosome? No.
-			for(unsigned int i = 0; i < problem_size; i++) {
+	/**
+	 * Get the hardware events counted for each phase of the last run.
+	 * @param counts The counts of each GenerationPhase.
+	 * @return The events that could be counted, a bit for each CounterEvent.
+	 */
+	unsigned int getPhaseCounts(std::vector<PhaseCounts > &counts) {
+		boost::unique_lock<boost::mutex> lock(counter_mutex);
+		counts.assign(phase_counts, phase_counts + NUM_GENERATION_PHASES);
+		return counter_events;
+	}
 
-				//std::cout << "Current = " << start_index + i << std::endl;
-				Chromosome<T> t = comp->population.at(start_index+i);
+	/**
+	 * Run in the pipelined mode, the population of each competitor is split into
+	 * chunks that the worker threads claim as they become free. A chunk is bred and
+	 * then evaluated by the same thread without waiting on the other threads, so
+	 * the only barrier left in a generation is the selection of the referee.
+	 * @param chunk_size The number of chromosomes in a chunk, 0 disables the pipelined mode.
+	 */
+	void setPipelined(unsigned int chunk_size) {
+		this->pipeline_chunk_size = chunk_size;
+	}
 
-				results.push_back(Result(start_index+i, m->fitness_function(t)));
-			}
+	/**
+	 * Tune the pipelined mode in the first generations of the run. Each pair of a
+	 * thread count (the powers of two up to the Manager's threads, and all of them)
+	 * and a chunk size (8, 32, 128 and one chunk per thread) runs for the
+	 * generations, the threads beyond the count do not claim chunks. The pair that
+	 * evaluated the most chromosomes a second is used for the rest of the run. The
+	 * tuned generations are part of the run. The run is pipelined even when no chunk
+	 * size is set, so cost scheduling is not used. Not used in the cellular mode.
+	 * @param generations The generations each pair is timed for, 0 disables the tuning.
+	 */
+	void setAutotune(unsigned int generations) {
+		this->autotune_generations = generations;
+	}
 
-			// Store them in results
-			comp->result_queue.push(results);
+	/**
+	 * Get the worker threads of each competitor the autotuning chose (the fastest
+	 * tried so far if the run ended first), 0 when the last run was not tuned.
+	 */
+	unsigned int getAutotunedThreads() {
+		return autotune_generations > 0 && !tiled() ? tuned.threads : 0;
+	}
 
-			results.clear();
+	/**
+	 * Get the chunk size the autotuning chose.
+	 */
+	unsigned int getAutotunedChunkSize() {
+		return tuned.chunk_size;
+	}
 
-			// Wait for all the threads to complete their fitness functions
-			m->wall.wait();
+	/**
+	 * Get the evaluations a second of the configuration the autotuning chose, 0
+	 * when no configuration ran for all of its generations.
+	 */
+	double getAutotunedRate() {
+		return tuned_rate;
+	}
 
-			// Breed the population
-		
-			// Each worker thread is responsible for replacing their own sub population of their competitor
-			std::vector<Chromosome<T > > sub_population = m->breed(comp->getPopulationSize(),
-				comp->getMutationRate(), comp->getCrossoverRate(), problem_size);
+	/**
+	 * Place the competitors on the NUMA nodes of the machine, round robin. The
+	 * worker threads and the thread of each competitor are pinned to the CPUs of
+	 * its node, and since each worker initializes its own range of the population
+	 * the chromosomes are allocated on the node.
+	 * @param numa_placement Whether the competitors are placed on NUMA nodes.
+	 */
+	void setNumaPlacement(bool numa_placement) {
+		this->numa_placement = numa_placement;
+	}
 
-			// Join the populations back together.
-			comp->population.copy(start_index, sub_population);
-		}
+	/**
+	 * Get the number of NUMA nodes the competitors are placed on.
+	 */
+	unsigned int getNumaNodes() {
+		return numa_placement ? std::min(topology.nodes(), num_competitor) : 1;
 	}
 
-	std::vector<Chromosome<T > > getSolutions() {
-		std::vector<Chromosome<T > > temp;
-		this->solutions.getAll(temp);
-		return temp;
+	/**
+	 * Set the maximum number of asynchronous fitness evaluations in flight at once.
+	 * @param max_in_flight The maximum number of evaluations, shared by all the worker threads.
+	 */
+	void setMaxInFlight(unsigned int max_in_flight) {
+		this->max_in_flight = std::max(max_in_flight, 1u);
 	}
 
+	/**
+	 * Get the number of times a worker process was restarted in the last run.
+	 */
+	unsigned long long getProcessRestarts() {
+		return process_restarts;
+	}
 
-private:
+	/**
+	 * Get the number of chromosomes that the worker processes could not evaluate in the last run.
+	 */
+	unsigned long long getProcessFailures() {
+		return process_failures;
+	}
 
 	/**
-	 * Setup the necessary variables for genetic algorithm.
+	 * Set the maximum number of distinct solutions that are kept.
+	 * @param max_solutions The capacity of the solution set.
 	 */
-	void initialize(std::vector<unsigned int > population_sizes, std::vector<double > mutation_rates, 
-		std::vector<double > crossover_rates) {
-		// Create the random objects that will be used
-		std::random_device rd;
-		rand_engine = std::mt19937(rd());
-		op_dist = std::uniform_real_distribution<float>(0.0, 1.0);
-		mutation_dist = std::uniform_real_distribution<float>(0.0, 1.0);
-		Chromosome<T>::initialize(chromosome_size, min_chromosome_value, max_chromosome_value);
-		done = false;
+	void setMaxSolutions(unsigned int max_solutions) {
+		solutions.setCapacity(max_solutions);
+	}
 
-		int problem_size;
-		int count;
+	/**
+	 * Set the maximum number of distinct chromosomes kept in the hall of fame.
+	 * @param size The capacity of the hall of fame.
+	 */
+	void setHallOfFameSize(unsigned int size) {
+		hall_of_fame.setCapacity(size);
+	}
 
-		for(unsigned int j = 0; j < num_competitor; j++) {
+	/**
+	 * Get the best distinct chromosomes found during the run, empty with multiple
+	 * objectives where the Pareto front is kept instead (see getParetoFront).
+	 * @param chromosomes The output chromosomes ordered from best to worst.
+	 * @param fitness The output fitness of each chromosome.
+	 */
+	void getHallOfFame(std::vector<Chromosome<T > > &chromosomes, std::vector<double > &fitness) {
+		hall_of_fame.getAll(chromosomes, fitness);
+	}
 
-			boost::shared_ptr<Competitor<T > > competitor(new Competitor<T >(population_sizes[j],
-				mutation_rates[j], crossover_rates[j]));
+	/**
+	 * Start from known chromosomes instead of random ones, e.g. a population file
+	 * (see PopulationFile) or the hall of fame of a previous run. The seeded part
+	 * of each competitor's initial population is filled with the seeds in order,
+	 * the seeds that do not fit are not used.
+	 * @param seeds The chromosomes, they must have the size of the chromosomes.
+	 */
+	void setSeeds(const std::vector<Chromosome<T > > &seeds) {
+		this->seeds = seeds;
+	}
 
-			competitors.push_back(competitor);
-			problem_size = competitors.back()->getPopulationSize()/max_num_threads;
-			count = 0;
+	/**
+	 * Set a function that creates the seeded chromosomes left once the seeds run
+	 * out, e.g. a heuristic for the problem. It is called by the worker threads
+	 * with a chromosome of the right size and the thread's random number generator.
+	 * @param generator The function, empty to fill the rest randomly.
+	 */
+	void setGenerator(boost::function<void (Chromosome<T > &, std::mt19937 &)> generator) {
+		this->generator = generator;
+	}
 
-			// Create the number of threads requested. If we are using self adaptive we will require 1 thread for the self adaptive
-			for(unsigned int i = 0; i < max_num_threads; i++) {
+	/**
+	 * Set the fraction of each competitor's initial population that is seeded,
+	 * the rest is random to keep some diversity.
+	 * @param fraction The fraction, 1 by default.
+	 */
+	void setSeedFraction(double fraction) {
+		seed_fraction = std::min(std::max(fraction, 0.0), 1.0);
+	}
 
-				if (i+1 == max_num_threads && competitors.back()->getPopulationSize() % max_num_threads != 0) {
+	/**
+	 * Set the maximum number of chromosomes kept in the Pareto front, the most
+	 * crowded are dropped first.
+	 * @param size The maximum size of the Pareto front.
+	 */
+	void setParetoFrontSize(unsigned int size) {
+		max_pareto_size = size;
+	}
 
-					// Handle the case where the problem_size does not evenly divide by the 
-					// number of threads available. Last thread receives remainder.
-					// This is not the best solution but is passable.
-					problem_size = competitors.back()->getPopulationSize() % max_num_threads;
-				}
+	/**
+	 * Get the non-dominated chromosomes found by the multi-objective mode.
+	 * @param chromosomes The output chromosomes.
+	 * @param objectives The output objectives of each chromosome.
+	 */
+	void getParetoFront(std::vector<Chromosome<T > > &chromosomes, std::vector<std::vector<double > > &objectives) {
+		chromosomes = pareto_front;
+		objectives = pareto_objectives;
+	}
 
-				fitness_group.create_thread(boost::bind(calcFitnessFunction, this, competitors.back(), count, problem_size));
-				count+= problem_size;
-			}
+	/**
+	 * Get the statistics of the last generation that was evaluated.
+	 */
+	GenerationStatistics getStatistics() {
+		return statistics;
+	}
 
-			competitor_group.create_thread(boost::bind(runGeneration, this, competitors.back()));
-		}
+    /**
+	 * Run the algorithm for the specified number of generations
+	 */	
+	unsigned int run(double (*fitness_function)(Chromosome<T>)) {
+		this->fitness_function = fitness_function;
+		this->objective_function = NULL;
+		this->async_function = NULL;
+		return runGenerations();
 	}
 
 	/**
-	 * Mutate the given chromosome on the likelihood of the mutation rate.
-	 * @param chromosome The chromosome to mutate.
+	 * Run the algorithm with an asynchronous fitness function. Each worker
+	 * thread starts evaluations for its range without waiting on them, up to
+	 * the limit set with setMaxInFlight. A fitness that throws counts as 0.
+	 * @param async_function The function starting the evaluation of a chromosome.
 	 */
-	void mutate(Chromosome<T > &chromosome, double mutation_rate) {
-		if(mutation_dist(rand_engine) <= mutation_rate) {
-			chromosome.mutate();
-		}
+	unsigned int run(std::future<double > (*async_function)(Chromosome<T>)) {
+		this->fitness_function = NULL;
+		this->objective_function = NULL;
+		this->async_function = async_function;
+		return runGenerations();
 	}
 
 	/**
-	 * Apply the fitness function to the population. Given the result of the
-	 * fitness function, the next population is bred.
+	 * Run the multi-objective (NSGA-II) algorithm for the specified number of
+	 * generations. The chromosomes are selected by their non-dominated front and
+	 * crowding distance rather than a fitness value. All objectives are maximized,
+	 * a chromosome whose objectives are all 1.0 is a solution.
+	 * Rate adaptation is not applied. The fitness statistics passed to the
+	 * termination criteria are of the mean objective of each chromosome and the
+	 * Pareto front takes the place of the hall of fame.
+	 * @param objective_function The function returning the objectives of a chromosome.
 	 */
-	static void runGeneration(Manager *m, boost::shared_ptr<Competitor<T > > comp) {
+	unsigned int run(std::vector<double > (*objective_function)(Chromosome<T>)) {
+		this->fitness_function = NULL;
+		this->objective_function = objective_function;
+		this->async_function = NULL;
+		return runGenerations();
+	}
+
+	/**
+	 * Get another chromosome and apply the fitness function.
+	 * @param m The manager the thread is running for.
+	 * @param comp The competitor the thread works for.
+	 * @param start_index The start of the thread's range of the competitor's population.
+	 * @param problem_size The size of the thread's range.
+	 * @param stream The number of the thread, used to give it its own random numbers.
+	 */
+	static void calcFitnessFunction(Manager *m, boost::shared_ptr<Competitor<T > > comp,
+		unsigned int start_index, unsigned int problem_size, unsigned int stream) {
 
-		// Get run generation to wait until run() is called
-		m->wall.wait();
+		//std::cout << "Worker Thread range " << start_index << " - " << start_index+problem_size << std::endl;
 
-		while(!m->done) {
+		std::vector<Result > results;
+		std::vector<Chromosome<T > > sub_population;
+		std::vector<double > parent_fitness;
+		std::vector<double > parent_cost;
+		EvaluationBuffers buffers;
 
-			//std::cout << "Tell workers to start" << std::endl;
+		// The temporary chromosomes of each generation are taken from the arena.
+		GenerationArena arena;
+		ArenaScope scope(&arena);
 
-			comp->fitness_results.clear();
+		// The thread is parked between runs, the buffers are kept for the next run.
+		while(m->startRun()) {
+			PerfCounters counters;
+			PhaseCounts phases[NUM_GENERATION_PHASES];
 
-			std::vector<Result > results;
-			std::vector<Chromosome<T > > solutions;
+			m->setupThread();
 
-			// Main threads will wait for all children to finish executing before proceeding.
-			// Construct the list of results for the fitness function in a map which maps the chromosome's index to the chromosome's fitness value.
-			// Wait for all the chromosomes to finish calculating their fitness value.
-			while(comp->fitness_results.size() < comp->getPopulationSize()) {
-				while(comp->result_queue.popAll(results, false)) {
+			if(m->perf_counters) {
+				m->addCounterEvents(counters.open());
+			}
 
-					comp->fitness_results.push_back(results);
+			// In the pipelined mode the thread works on chunks rather than its own range.
+			unsigned int chunk_size = m->tiled() ? 0 : m->pipeline_chunk_size;
+			unsigned int buffer_size = chunk_size > 0 ? std::min(chunk_size, comp->getPopulationSize()) : problem_size;
+			results.reserve(buffer_size);
+			sub_population.reserve(buffer_size + 1);
+			parent_fitness.reserve(buffer_size + 1);
+			parent_cost.reserve(buffer_size + 1);
+
+			// The placement is only final once run() is called, pinning before the
+			// population is initialized makes the first touch node local.
+			if(m->numa_placement) {
+				m->topology.pin(comp->getNode());
+			}
 
-					for(unsigned int i = 0; i < results.size(); i++) {
-						// Store the solutions locally 
-						if(results[i].getResult() == 1.0) {
-							solutions.push_back(comp->population.at(results[i].getIndex()));
+			// The seed is only final once run() is called.
+			std::seed_seq seed_sequence{m->seed, stream};
+			std::mt19937 engine(seed_sequence);
+
+			if(m->tiled()) {
+				m->runTile(comp, start_index, problem_size, stream, results, sub_population, parent_fitness,
+					parent_cost, buffers, arena, engine, counters, phases);
+			} else if(chunk_size > 0) {
+				unsigned int population_size = comp->getPopulationSize();
+
+				for(unsigned int generation = 0; !m->done; generation++) {
+
+					// Nothing allocated in the last generation is still in use.
+					arena.reset();
+
+					// The autotuning changes the chunk size and the threads between generations.
+					chunk_size = m->pipeline_chunk_size;
+					unsigned int chunks = (population_size + chunk_size - 1) / chunk_size;
+					bool active = stream % m->max_num_threads < m->active_threads;
+
+					// Each chunk is bred (initialized in the first generation) and evaluated straight
+					// away by the thread that claimed it, so a thread that finishes early takes more
+					// chunks instead of waiting on the slowest range.
+					int chunk;
+					while(active && (chunk = comp->claimChunk(generation, chunks)) >= 0) {
+						unsigned int start = chunk * chunk_size;
+						unsigned int size = std::min(chunk_size, population_size - start);
+
+						if(generation == 0) {
+							comp->initPopulation(start, size, m->chromosome_size, engine, m->seeds,
+								m->seeded(comp), m->generator);
+							m->markInitialized();
+						} else {
+							counters.start();
+							m->breedRange(comp, start, size, sub_population, parent_fitness, parent_cost, engine);
+							counters.stop(phases[BREEDING_PHASE]);
 						}
+
+						counters.start();
+						m->evaluate(comp, start, size, results, buffers);
+						counters.stop(phases[EVALUATION_PHASE]);
+						comp->result_queue.push(results);
+						results.clear();
 					}
 
-					// Add the solutions to the master solutions vector
-					m->solutions.push_back(solutions);
+					counters.start();
+					m->improve(comp, results, engine);
+					counters.stop(phases[EVALUATION_PHASE]);
 
-					results.clear();
-					solutions.clear();
+					// Wait for the referee to set up the selection of the next generation.
+					counters.start();
+					m->merge(stream);
+					counters.stop(phases[SELECTION_PHASE]);
+					m->wall.wait();
 				}
-			}
-
-			// Wait for the other competitors to finish mutating
-			m->whistle.wait();
-
-			// Wait for the referee to set up the next generation
-			m->wall.wait();
-		}
-	}
-
-	void referee(bool final=false) {
+			} else {
+				// Each thread initializes its own range of the population in place.
+				comp->initPopulation(start_index, problem_size, m->chromosome_size, engine, m->seeds,
+					m->seeded(comp), m->generator);
+				m->markInitialized();
 
-		// Wait for the competitor threads to signal that their populations are ready.
-		whistle.wait();
+				for(unsigned int generation = 0; !m->done; generation++) {
 
-		// This should prob. be safe a vector and an attribute of Manager.
-		master_population.clear();
-		master_fitness.clear();
-		std::vector<Result > c_fitness;
-		std::vector<Chromosome<T > > temp_population;
-		unsigned int offset = 0;
+					// Nothing allocated in the last generation is still in use.
+					arena.reset();
 
-		for(unsigned int i = 0; i < competitors.size(); i++) {
-			competitors[i]->fitness_results.getAll(c_fitness);
-			competitors[i]->population.getAll(temp_population);
+					counters.start();
+					if(m->schedule_chunk_size > 0) {
+						m->evaluateScheduled(comp, start_index, problem_size, generation, results, buffers);
+					} else {
+						m->evaluate(comp, start_index, problem_size, results, buffers);
 
-			for(unsigned int j = 0; j < competitors[i]->getPopulationSize(); j++) {
+						// Store them in results
+						comp->result_queue.push(results);
 
-				// Add the conversion offset
-				c_fitness[j].offsetIndex(offset);
+						results.clear();
+					}
+					m->improve(comp, results, engine);
+					counters.stop(phases[EVALUATION_PHASE]);
+
+					// Wait for all the threads to complete their fitness functions
+					counters.start();
+					m->merge(stream);
+					counters.stop(phases[SELECTION_PHASE]);
+					m->wall.wait();
+
+					// The last generation is not bred.
+					if(m->done) {
+						break;
+					}
 
-				// Append the value to the master fitness function
-				master_fitness.push_back(c_fitness[j]);
+					// Breed the population
+		
+					// Each worker thread is responsible for replacing their own sub population of their competitor
+					counters.start();
+					m->breedRange(comp, start_index, problem_size, sub_population, parent_fitness, parent_cost, engine);
+					counters.stop(phases[BREEDING_PHASE]);
+				}
 			}
-			
-			// Append the chromosome to the master population
-			//master_population.push_back(temp_population);
-			master_population.push_back(temp_population);
-
-			// The next fitness function master index location is at sum(i=0,i=prev_competitor,fitness_size)
-			// e.g. competitor 2's master index location for the local first value (i = 1, c_fitness[0]) is competitor_1.size()
-			// and the second local value (i = 1, c_fitness[1]) is competitor_1.size() + 1 and so on.
-			offset+= competitors[i]->fitness_results.size();
-
+			m->addPhaseCounts(phases);
+			m->finishRun();
 		}
+	}
 
-		rw.init(master_fitness);
+	/**
+	 * Park the calling thread of the Manager until the next run starts.
+	 * @return Whether there is a run, false once the Manager is destroyed.
+	 */
+	bool startRun() {
+		wall.wait();
+		return !closing;
+	}
 
-		if(final || solutions.size() > 0) {
-			done = true;
+	/**
+	 * Wait for every thread of the Manager to finish the run, the pinned threads
+	 * are let go of their node since the next run may not place them.
+	 */
+	void finishRun() {
+		if(numa_placement) {
+			topology.unpin();
+		}
+		wall.wait();
+	}
+
+	/**
+	 * Set up the chromosome range and the state of the problem on the calling
+	 * thread, both are kept per thread so Managers of different problems can run
+	 * in the same process at once.
+	 */
+	void setupThread() {
+		Chromosome<T>::initialize(chromosome_size, min_chromosome_value, max_chromosome_value);
+		if(thread_setup) {
+			thread_setup();
+		}
+	}
+
+	/**
+	 * Add the hardware events counted by a thread to the totals of the run.
+	 * @param phases The counts of each phase of the thread.
+	 */
+	void addPhaseCounts(const PhaseCounts *phases) {
+		boost::unique_lock<boost::mutex> lock(counter_mutex);
+		for(unsigned int i = 0; i < NUM_GENERATION_PHASES; i++) {
+			phase_counts[i]+= phases[i];
+		}
+	}
+
+	/**
+	 * Record the hardware events a thread could count.
+	 * @param events A bit for each CounterEvent.
+	 */
+	void addCounterEvents(unsigned int events) {
+		boost::unique_lock<boost::mutex> lock(counter_mutex);
+		counter_events|= events;
+	}
+
+	/**
+	 * Evaluate a range of a competitor's population with the fitness function
+	 * (or the objective function, worker processes, asynchronous fitness or surrogate).
+	 * @param comp The competitor.
+	 * @param start_index The start of the range.
+	 * @param problem_size The size of the range.
+	 * @param results The fitness of each chromosome is appended to this.
+	 * @param buffers The buffers of the calling thread.
+	 */
+	void evaluate(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index,
+		unsigned int problem_size, std::vector<Result > &results, EvaluationBuffers &buffers) {
+
+		// Could have a look up table (cache) of recent solutions but this is most likely a completely alternative idea
+
+		if(process_pool) {
+			evaluateInProcesses(comp, start_index, problem_size, results, buffers.genes, buffers.outputs);
+		} else if(async_function) {
+			evaluateAsync(comp, start_index, problem_size, results);
+		} else if(surrogate_fraction > 0 && fitness_function) {
+			evaluateWithSurrogate(comp, start_index, problem_size, results, buffers.predictions, buffers.order);
+		} else {
+			// Can we trust the user to not change the chromosome? No.
+			for(unsigned int i = 0; i < problem_size; i++) {
+
+				//std::cout << "Current = " << start_index + i << std::endl;
+				Chromosome<T> t = comp->population.at(start_index+i);
+
+				if(objective_function) {
+					// The selection value is set by the referee once all the objectives are known.
+					std::vector<double > &objectives = comp->objectives[start_index+i];
+					objectives = objective_function(t);
+					results.push_back(Result(start_index+i, objectiveFitness(objectives)));
+				} else {
+					results.push_back(Result(start_index+i, fitness_function(t)));
+				}
+			}
+		}
+	}
+
+	/**
+	 * Evaluate the chunks of a competitor's population in the scheduled order, the
+	 * calling thread claims chunks until every chunk of the generation is claimed.
+	 * @param comp The competitor.
+	 * @param start_index The start of the thread's range, whose expected costs it sets.
+	 * @param problem_size The size of the thread's range.
+	 * @param generation The generation of the calling thread.
+	 * @param results Buffer for the fitness of a chunk, kept by the calling thread.
+	 * @param buffers The buffers of the calling thread.
+	 */
+	void evaluateScheduled(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index,
+		unsigned int problem_size, unsigned int generation, std::vector<Result > &results,
+		EvaluationBuffers &buffers) {
+
+		for(unsigned int i = start_index; i < start_index + problem_size; i++) {
+			if(cost_hint) {
+				comp->cost_hints[i] = cost_hint(comp->population.at(i));
+				comp->expected_costs[i] = comp->cost_hints[i] * comp->getCostScale();
+			} else if(!(comp->expected_costs[i] > 0)) {
+				comp->expected_costs[i] = comp->getMeanCost();
+			}
+		}
+
+		// One thread orders the chunks once every expected cost is known.
+		if(comp->getScheduleWall().wait()) {
+			comp->scheduleChunks(schedule_chunk_size);
+		}
+		comp->getScheduleWall().wait();
+
+		unsigned int population_size = comp->getPopulationSize();
+		unsigned int chunks = comp->schedule.size();
+		int claim;
+		while((claim = comp->claimChunk(generation, chunks)) >= 0) {
+			unsigned int start = comp->schedule[claim] * schedule_chunk_size;
+			unsigned int size = std::min(schedule_chunk_size, population_size - start);
+
+			// The worker processes, asynchronous fitness and surrogate evaluate the chunk
+			// as a batch so its time is shared out evenly.
+			if(process_pool || async_function || surrogate_fraction > 0) {
+				std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+				evaluate(comp, start, size, results, buffers);
+				double seconds = std::chrono::duration<double >(std::chrono::steady_clock::now() - begin).count();
+				std::fill(comp->costs.begin() + start, comp->costs.begin() + start + size, seconds / size);
+			} else {
+				for(unsigned int i = start; i < start + size; i++) {
+					std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+					evaluate(comp, i, 1, results, buffers);
+					comp->costs[i] = std::chrono::duration<double >(std::chrono::steady_clock::now() - begin).count();
+				}
+			}
+
+			comp->result_queue.push(results);
+			results.clear();
+		}
+	}
+
+	/**
+	 * Whether the memetic mode is used.
+	 */
+	bool memetic() {
+		return local_search && local_search_count > 0 && !objective_function;
+	}
+
+	/**
+	 * Apply the local search of the memetic mode to the best chromosomes of the
+	 * competitor's generation, chosen by the competitor's thread once the whole
+	 * generation is evaluated (see chooseImprovements). The worker threads claim
+	 * the chromosomes one at a time and queue their improved fitness.
+	 * @param comp The competitor.
+	 * @param results Buffer for the improved fitness, kept by the calling thread.
+	 * @param engine The random number generator of the calling thread.
+	 */
+	void improve(boost::shared_ptr<Competitor<T > > comp, std::vector<Result > &results, std::mt19937 &engine) {
+
+		if(!memetic()) {
+			return;
+		}
+
+		// Wait for the competitor's thread to choose the chromosomes.
+		comp->getImproveWall().wait();
+
+		unsigned int claim;
+		while((claim = comp->improvement_claims++) < comp->improvement_targets.size()) {
+			unsigned int index = comp->improvement_targets[claim];
+			double fitness = comp->fitness_values[index];
+			Chromosome<T > &chromosome = comp->population.at(index);
+			Chromosome<T > improved = chromosome;
+			local_search_evaluations+= local_search(improved, fitness, local_search_budget, engine);
+
+			if(write_back == LAMARCKIAN || fitness == 1.0) {
+				chromosome = improved;
+			}
+			comp->predicted[index] = false;
+			results.push_back(Result(index, fitness));
+		}
+		comp->result_queue.push(results);
+		results.clear();
+
+		// Every improvement is queued once the competitor's thread passes this.
+		comp->getImproveWall().wait();
+	}
+
+	/**
+	 * Choose the best chromosomes of a competitor's evaluated generation for the
+	 * local search. Solutions can not be improved and a failed evaluation (NaN)
+	 * is left alone.
+	 * @param comp The competitor.
+	 * @param order Buffer for the indexes, kept by the calling thread.
+	 */
+	void chooseImprovements(boost::shared_ptr<Competitor<T > > comp, std::vector<unsigned int > &order) {
+
+		const std::vector<double > &fitness = comp->fitness_values;
+		order.clear();
+		for(unsigned int i = 0; i < comp->getPopulationSize(); i++) {
+			if(fitness[i] < 1.0) {
+				order.push_back(i);
+			}
+		}
+
+		unsigned int count = std::min(local_search_count, static_cast<unsigned int >(order.size()));
+		std::partial_sort(order.begin(), order.begin() + count, order.end(),
+			[&fitness](unsigned int a, unsigned int b) { return fitness[a] > fitness[b]; });
+		comp->improvement_targets.assign(order.begin(), order.begin() + count);
+		comp->improvement_claims = 0;
+	}
+
+	/**
+	 * The built in local search, see setHillClimbing.
+	 */
+	unsigned int hillClimb(Chromosome<T > &chromosome, double &fitness, unsigned int budget, std::mt19937 &engine) {
+		unsigned int evaluations = 0;
+		for(; evaluations < budget && fitness < 1.0; evaluations++) {
+			Chromosome<T > neighbour = chromosome;
+			neighbour.mutate(engine);
+			double neighbour_fitness = evaluateChromosome(neighbour);
+			// Moving to equally fit neighbours lets the search cross plateaus.
+			if(neighbour_fitness >= fitness) {
+				chromosome = neighbour;
+				fitness = neighbour_fitness;
+			}
+		}
+		return evaluations;
+	}
+
+	/**
+	 * Evaluate a single chromosome outside the population with the same backend as
+	 * the population: the worker processes, or the asynchronous fitness within the
+	 * limit of evaluations in flight, or the fitness function.
+	 * @param chromosome The chromosome.
+	 * @return The fitness, 0 if the evaluation failed.
+	 */
+	double evaluateChromosome(Chromosome<T > &chromosome) {
+
+		if(process_pool) {
+			static thread_local std::vector<T > genes;
+			genes.assign(chromosome_size, T());
+			unsigned int size = std::min(chromosome.size(), chromosome_size);
+			for(unsigned int j = 0; j < size; j++) {
+				genes[j] = chromosome[j];
+			}
+			double output;
+			process_pool->evaluate(reinterpret_cast<const char *>(genes.data()), 1, &output);
+			return std::isnan(output) ? 0.0 : output;
+		}
+
+		if(async_function) {
+			startEvaluation(true);
+			double fitness;
+			try {
+				fitness = async_function(chromosome).get();
+			}
+			catch(...) {
+				fitness = 0;
+			}
+			in_flight--;
+			return fitness;
+		}
+
+		return fitness_function(chromosome);
+	}
+
+	/**
+	 * Breed the next generation of a range of a competitor's population and copy it
+	 * over the range. The range starting at 0 carries over the competitor's elites.
+	 * @param comp The competitor.
+	 * @param start_index The start of the range.
+	 * @param problem_size The size of the range.
+	 * @param sub_population Buffer for the bred chromosomes, kept by the calling thread.
+	 * @param parent_fitness Buffer for the fitness of their parents, kept by the calling thread.
+	 * @param parent_cost Buffer for the evaluation cost of their parents, kept by the calling thread.
+	 * @param engine The random number generator of the calling thread.
+	 */
+	void breedRange(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index, unsigned int problem_size,
+		std::vector<Chromosome<T > > &sub_population, std::vector<double > &parent_fitness,
+		std::vector<double > &parent_cost, std::mt19937 &engine) {
+
+		if(start_index == 0) {
+			for(unsigned int i = 0; i < comp->elites.size() && i < problem_size; i++) {
+				sub_population.push_back(comp->elites[i]);
+				parent_fitness.push_back(std::numeric_limits<double >::quiet_NaN());
+				parent_cost.push_back(std::numeric_limits<double >::quiet_NaN());
+			}
+		}
+
+		breed(sub_population, parent_fitness, parent_cost, comp->getMutationRate(), comp->getCrossoverRate(),
+			problem_size, engine);
+
+		// Join the populations back together.
+		comp->population.copy(start_index, sub_population);
+		std::copy(parent_fitness.begin(), parent_fitness.end(), comp->parent_fitness.begin() + start_index);
+		std::copy(parent_cost.begin(), parent_cost.end(), comp->expected_costs.begin() + start_index);
+
+		sub_population.clear();
+		parent_fitness.clear();
+		parent_cost.clear();
+	}
+
+	std::vector<Chromosome<T > > getSolutions() {
+		std::vector<Chromosome<T > > temp;
+		this->solutions.getAll(temp);
+		return temp;
+	}
+
+
+private:
+
+	/**
+	 * Run the generations with the fitness or objective function that has been set.
+	 */
+	unsigned int runGenerations() {
+
+		// The threads are kept between runs, only what a run found is cleared.
+		done = false;
+		solutions.clear();
+		hall_of_fame.clear();
+		pareto_front.clear();
+		pareto_objectives.clear();
+		in_flight = 0;
+		num_objectives = 0;
+		process_restarts = 0;
+		process_failures = 0;
+
+		// Only the storage is created here, the worker threads fill in the chromosomes.
+		for(unsigned int i = 0; i < num_competitor; i++) {
+			competitors[i]->initPopulation();
+		}
+		setupThread();
+		statistics = GenerationStatistics();
+		surrogate_predictions = surrogate.getPredictions();
+		local_search_evaluations = 0;
+		for(unsigned int i = 0; i < NUM_GENERATION_PHASES; i++) {
+			phase_counts[i] = PhaseCounts();
+		}
+		counter_events = 0;
+		for(unsigned int i = 0; i < termination_criteria.size(); i++) {
+			termination_criteria[i]->init();
+		}
+		start_time = std::chrono::steady_clock::now();
+		allocation_count = AllocationCounter::count();
+		initialized_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			start_time.time_since_epoch()).count();
+
+		// The workers are forked while every thread is waiting on the wall.
+		if(process_workers > 0) {
+			unsigned int output_size = objective_function ? MAX_OBJECTIVES + 1 : 1;
+			process_pool.reset(new ProcessPool(process_workers, process_batch_size, chromosome_size * sizeof(T),
+				output_size, boost::bind(evaluateEncoded, this, _1, _2)));
+		}
+
+		PerfCounters counters;
+		PhaseCounts phases[NUM_GENERATION_PHASES];
+		if(perf_counters) {
+			addCounterEvents(counters.open());
+		}
+
+		if(tiled()) {
+			tile_reports.resize(TILE_WINDOW * num_competitor * max_num_threads);
+			tile_evaluated.reset(num_competitor * max_num_threads);
+			tile_bred.reset(num_competitor * max_num_threads);
+			tile_reduced.reset(1);
+		}
+
+		active_threads = max_num_threads;
+		tune_configurations.clear();
+		if(autotune_generations > 0 && !tiled()) {
+			startTuning();
+		}
+
+		wall.wait();
+		unsigned int i;
+		if(tiled()) {
+			// The tiles run their own generations, only their statistics are gathered here.
+			counters.start();
+			i = reduceTiles();
+			counters.stop(phases[REFEREE_PHASE]);
+		} else {
+			for(i = 0; i < max_generation_number && !done; i++) {
+			//for(unsigned int i = 0; i < 1; i++) {
+				//std::cout << "Generation " << i << std::endl;
+
+				// On the last generation
+				counters.start();
+				if(i+1 == max_generation_number) {
+				//if(i+1 == 1) {
+					referee(true);
+				}
+				else {
+					referee();
+				}
+				counters.stop(phases[REFEREE_PHASE]);
+				//runGeneration();
+				
+			}
+		}
+
+		done = true;
+
+		// Wait for the threads to park until the next run.
+		wall.wait();
+		addPhaseCounts(phases);
+
+		if(process_pool) {
+			process_restarts = process_pool->getRestarts();
+			process_failures = process_pool->getFailures();
+			process_pool.reset();
+		}
+		return i;
+	}
+
+	/**
+	 * Setup the necessary variables for genetic algorithm.
+	 */
+	void initialize(std::vector<unsigned int > population_sizes, std::vector<double > mutation_rates, 
+		std::vector<double > crossover_rates) {
+		// Create the random objects that will be used
+		std::random_device rd;
+		seed = rd();
+		op_dist = std::uniform_real_distribution<float>(0.0, 1.0);
+		mutation_dist = std::uniform_real_distribution<float>(0.0, 1.0);
+		Chromosome<T>::initialize(chromosome_size, min_chromosome_value, max_chromosome_value);
+		done = false;
+		closing = false;
+		fitness_function = NULL;
+		objective_function = NULL;
+		async_function = NULL;
+		seed_fraction = 1.0;
+		mutation_mode = CHROMOSOME_MUTATION;
+		crossover_type = ONE_POINT;
+
+		int problem_size;
+		int count;
+
+		for(unsigned int j = 0; j < num_competitor; j++) {
+
+			boost::shared_ptr<Competitor<T > > competitor(new Competitor<T >(population_sizes[j],
+				mutation_rates[j], crossover_rates[j]));
+
+			competitor->setNode(j % topology.nodes());
+			competitor->setWorkers(max_num_threads);
+			competitors.push_back(competitor);
+			problem_size = competitors.back()->getPopulationSize()/max_num_threads;
+			count = 0;
+
+			// Create the number of threads requested. The competitor's own thread adapts its rates.
+			for(unsigned int i = 0; i < max_num_threads; i++) {
+
+				if (i+1 == max_num_threads && competitors.back()->getPopulationSize() % max_num_threads != 0) {
+
+					// Handle the case where the problem_size does not evenly divide by the 
+					// number of threads available. Last thread also takes the remainder.
+					problem_size+= competitors.back()->getPopulationSize() % max_num_threads;
+				}
+
+				fitness_group.create_thread(boost::bind(calcFitnessFunction, this, competitors.back(), count,
+					problem_size, j*max_num_threads + i));
+				count+= problem_size;
+			}
+
+			competitor_group.create_thread(boost::bind(runGeneration, this, competitors.back()));
+		}
+	}
+
+	/**
+	 * Evaluate a range of a competitor's population with the worker processes.
+	 * @param comp The competitor.
+	 * @param start_index The start of the range.
+	 * @param problem_size The size of the range.
+	 * @param results The fitness of each chromosome is appended to this.
+	 * @param genes Buffer for the chromosomes, kept by the calling thread.
+	 * @param outputs Buffer for the fitness, kept by the calling thread.
+	 */
+	void evaluateInProcesses(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index,
+		unsigned int problem_size, std::vector<Result > &results, std::vector<T > &genes,
+		std::vector<double > &outputs) {
+
+		unsigned int output_size = objective_function ? MAX_OBJECTIVES + 1 : 1;
+		genes.resize(problem_size * chromosome_size);
+		outputs.resize(problem_size * output_size);
+
+		for(unsigned int i = 0; i < problem_size; i++) {
+			Chromosome<T > &chromosome = comp->population.at(start_index + i);
+			// Variable length chromosomes (programs) are padded to the maximum size.
+			unsigned int size = std::min(chromosome.size(), chromosome_size);
+			for(unsigned int j = 0; j < size; j++) {
+				genes[i * chromosome_size + j] = chromosome[j];
+			}
+			std::fill(genes.begin() + i * chromosome_size + size, genes.begin() + (i + 1) * chromosome_size, T());
+		}
+
+		process_pool->evaluate(reinterpret_cast<const char *>(genes.data()), problem_size, outputs.data());
+
+		for(unsigned int i = 0; i < problem_size; i++) {
+			const double *output = &outputs[i * output_size];
+			bool failed = std::isnan(output[0]);
+
+			if(objective_function) {
+				std::vector<double > &objectives = comp->objectives[start_index + i];
+				if(failed) {
+					objectives.assign(num_objectives, 0.0);
+				} else {
+					objectives.assign(output + 1, output + 1 + static_cast<unsigned int >(output[0]));
+					num_objectives = objectives.size();
+				}
+				results.push_back(Result(start_index + i, objectiveFitness(objectives)));
+			} else {
+				results.push_back(Result(start_index + i, failed ? 0.0 : output[0]));
+			}
+		}
+	}
+
+	/**
+	 * Evaluate a range of a competitor's population, only the chromosomes with the
+	 * best predicted fitness are evaluated with the fitness function. The evaluated
+	 * chromosomes are added to the surrogate.
+	 * @param comp The competitor.
+	 * @param start_index The start of the range.
+	 * @param problem_size The size of the range.
+	 * @param results The fitness of each chromosome is appended to this.
+	 * @param predictions Buffer for the predicted fitness, kept by the calling thread.
+	 * @param order Buffer for the order of the range, kept by the calling thread.
+	 */
+	void evaluateWithSurrogate(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index,
+		unsigned int problem_size, std::vector<Result > &results, std::vector<double > &predictions,
+		std::vector<unsigned int > &order) {
+
+		bool ready = surrogate.ready();
+		predictions.resize(problem_size);
+		order.resize(problem_size);
+		for(unsigned int i = 0; i < problem_size; i++) {
+			order[i] = i;
+			predictions[i] = ready ? surrogate.predict(comp->population.at(start_index + i)) : 0;
+		}
+
+		// Everything is evaluated until the surrogate has been trained.
+		unsigned int evaluated = problem_size;
+		if(ready) {
+			evaluated = std::min(problem_size, static_cast<unsigned int >(std::ceil(surrogate_fraction * problem_size)));
+			auto better = [&predictions](unsigned int a, unsigned int b) { return predictions[a] > predictions[b]; };
+			std::nth_element(order.begin(), order.begin() + evaluated, order.end(), better);
+		}
+
+		double error = 0;
+		unsigned int used = 0;
+		for(unsigned int i = 0; i < problem_size; i++) {
+			unsigned int index = start_index + order[i];
+			double prediction = predictions[order[i]];
+			Chromosome<T > &chromosome = comp->population.at(index);
+
+			// A predicted solution has to be confirmed by the fitness function.
+			if(i < evaluated || prediction >= 1.0) {
+				double value = fitness_function(chromosome);
+				if(ready) {
+					error+= std::fabs(prediction - value);
+				}
+				surrogate.add(chromosome, value);
+				comp->predicted[index] = false;
+				results.push_back(Result(index, value));
+			} else {
+				comp->predicted[index] = true;
+				results.push_back(Result(index, prediction));
+				used++;
+			}
+		}
+
+		surrogate.record(error, ready ? problem_size - used : 0, used);
+	}
+
+	/**
+	 * Evaluate a range of a competitor's population with the asynchronous fitness
+	 * function. The evaluations are started in order and collected oldest first,
+	 * once the limit of evaluations in flight is reached the thread collects its
+	 * oldest evaluation before starting another. An evaluation that throws, either
+	 * when it is started or from its future, gets a fitness of 0.
+	 * @param comp The competitor.
+	 * @param start_index The start of the range.
+	 * @param problem_size The size of the range.
+	 * @param results The fitness of each chromosome is appended to this.
+	 */
+	void evaluateAsync(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index,
+		unsigned int problem_size, std::vector<Result > &results) {
+
+		typedef std::pair<unsigned int, std::future<double > > Pending;
+		std::deque<Pending, ArenaAllocator<Pending > > pending;
+
+		for(unsigned int i = 0; i < problem_size; i++) {
+			while(!startEvaluation(pending.empty())) {
+				collectEvaluation(pending, results);
+			}
+
+			// A function that fails before it returns a future (e.g. std::async out of
+			// threads) gives no fitness, like a future that holds an exception.
+			std::future<double > fitness;
+			try {
+				fitness = async_function(comp->population.at(start_index + i));
+			}
+			catch(...) {
+				results.push_back(Result(start_index + i, 0));
+				in_flight--;
+				continue;
+			}
+			pending.push_back(Pending(start_index + i, std::move(fitness)));
+		}
+
+		while(!pending.empty()) {
+			collectEvaluation(pending, results);
+		}
+	}
+
+	/**
+	 * Take one of the evaluations that can be in flight.
+	 * @param block Whether to wait for the other threads to finish an evaluation,
+	 * only used when the calling thread has none of its own to collect.
+	 * @return Whether the evaluation can be started.
+	 */
+	bool startEvaluation(bool block) {
+		unsigned int current = in_flight;
+		while(true) {
+			if(current < max_in_flight) {
+				if(in_flight.compare_exchange_weak(current, current + 1)) {
+					return true;
+				}
+			} else if(block) {
+				boost::this_thread::yield();
+				current = in_flight;
+			} else {
+				return false;
+			}
+		}
+	}
+
+	/**
+	 * Wait for the oldest evaluation of the calling thread and append its fitness to the results.
+	 */
+	template <class Queue>
+	void collectEvaluation(Queue &pending, std::vector<Result > &results) {
+		double fitness;
+		try {
+			fitness = pending.front().second.get();
+		}
+		catch(...) {
+			fitness = 0;
+		}
+		results.push_back(Result(pending.front().first, fitness));
+		pending.pop_front();
+		in_flight--;
+	}
+
+	/**
+	 * Evaluate a chromosome copied out by evaluateInProcesses, run in a worker process.
+	 * @param m The manager the worker process was forked from.
+	 * @param input The elements of the chromosome.
+	 * @param output The fitness, or the number of objectives followed by the objectives.
+	 */
+	static void evaluateEncoded(Manager *m, const char *input, double *output) {
+
+		// The worker process was forked from a thread that may have an arena selected.
+		ArenaScope heap(NULL);
+
+		const T *genes = reinterpret_cast<const T *>(input);
+		Chromosome<T > chromosome(m->chromosome_size);
+		for(unsigned int i = 0; i < m->chromosome_size; i++) {
+			chromosome[i] = genes[i];
+		}
+
+		if(m->objective_function) {
+			std::vector<double > objectives = m->objective_function(chromosome);
+			unsigned int count = std::min(static_cast<unsigned int >(objectives.size()), MAX_OBJECTIVES);
+			output[0] = count;
+			std::copy(objectives.begin(), objectives.begin() + count, output + 1);
+		} else {
+			output[0] = m->fitness_function ? m->fitness_function(chromosome) : m->async_function(chromosome).get();
+		}
+	}
+
+	/**
+	 * Get the fitness of a chromosome in the multi-objective mode, the mean of its
+	 * objectives. It is only 1.0 for a solution and is what the statistics, the
+	 * termination criteria and the solutions are based on, the selection uses
+	 * the fronts instead.
+	 * @param objectives The objectives of the chromosome.
+	 */
+	static double objectiveFitness(const std::vector<double > &objectives) {
+		if(objectives.empty()) {
+			return 0;
+		}
+		double sum = 0;
+		for(unsigned int i = 0; i < objectives.size(); i++) {
+			sum+= objectives[i];
+		}
+		return sum / objectives.size();
+	}
+
+	/**
+	 * Get the number of chromosomes of a competitor's initial population that are seeded.
+	 * @param comp The competitor.
+	 */
+	unsigned int seeded(boost::shared_ptr<Competitor<T > > comp) {
+		if(seeds.empty() && !generator) {
+			return 0;
+		}
+		return comp->getPopulationSize() * seed_fraction;
+	}
+
+	/**
+	 * Record that a worker thread has finished initializing its range of the population.
+	 */
+	void markInitialized() {
+		long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		long long previous = initialized_time;
+		while(previous < now && !initialized_time.compare_exchange_weak(previous, now)) {
+		}
+	}
+
+	/**
+	 * Mutate the given chromosome on the likelihood of the mutation rate.
+	 * @param chromosome The chromosome to mutate.
+	 * @param engine The random number generator of the calling thread.
+	 */
+	void mutate(Chromosome<T > &chromosome, double mutation_rate, std::mt19937 &engine) {
+		if(mutation_mode == GENE_MUTATION) {
+			chromosome.mutate(mutation_rate, engine);
+			return;
+		}
+
+		std::uniform_real_distribution<float> dist(mutation_dist.param());
+		if(dist(engine) <= mutation_rate) {
+			chromosome.mutate(engine);
+		}
+	}
+
+	/**
+	 * Apply the fitness function to the population. Given the result of the
+	 * fitness function, the next population is bred.
+	 */
+	static void runGeneration(Manager *m, boost::shared_ptr<Competitor<T > > comp) {
+
+		std::vector<Result > results;
+		std::vector<unsigned int > order;
+
+		// Get run generation to wait until run() is called, between runs the thread is parked.
+		while(m->startRun()) {
+			m->setupThread();
+
+			if(m->numa_placement) {
+				m->topology.pin(comp->getNode());
+			}
+
+			// The tiles of the cellular mode gather their own fitness.
+			while(!m->done && !m->tiled()) {
+
+				//std::cout << "Tell workers to start" << std::endl;
+
+				unsigned int gathered = 0;
+
+				// Running statistics used to adapt the rates.
+				unsigned int compared = 0;
+				unsigned int successes = 0;
+
+				// Main threads will wait for all children to finish executing before proceeding.
+				// The fitness of each chromosome is stored at the chromosome's index.
+				// Wait for all the chromosomes to finish calculating their fitness value.
+				while(gathered < comp->getPopulationSize()) {
+					while(comp->result_queue.popAll(results, false)) {
+
+						gathered+= results.size();
+
+						for(unsigned int i = 0; i < results.size(); i++) {
+							comp->fitness_values[results[i].getIndex()] = results[i].getResult();
+
+							// Only new solutions are copied into the solution set
+							if(results[i].getResult() == 1.0) {
+								m->solutions.insert(comp->population.at(results[i].getIndex()));
+							}
+
+							double value = results[i].getResult();
+							double parent = comp->parent_fitness[results[i].getIndex()];
+							if(!std::isnan(parent)) {
+								compared++;
+								if(value > parent) {
+									successes++;
+								}
+							}
+						}
+
+						results.clear();
+					}
+				}
+
+				// The worker threads improve the best chromosomes of the whole generation.
+				if(m->memetic()) {
+					m->chooseImprovements(comp, order);
+					comp->getImproveWall().wait();
+					comp->getImproveWall().wait();
+
+					while(comp->result_queue.popAll(results, false)) {
+						for(unsigned int i = 0; i < results.size(); i++) {
+							comp->fitness_values[results[i].getIndex()] = results[i].getResult();
+							if(results[i].getResult() == 1.0) {
+								m->solutions.insert(comp->population.at(results[i].getIndex()));
+							}
+						}
+						results.clear();
+					}
+				}
+
+				// With multiple objectives the elites are selected by the referee once the fronts are known.
+				if(!m->objective_function) {
+					m->selectElites(comp, &comp->fitness_values[0], order);
+				}
+
+				// The first generation has no parents to compare against.
+				if(compared > 0 && !m->objective_function) {
+					const double *values = &comp->fitness_values[0];
+					unsigned int n = comp->getPopulationSize();
+					double mean = Fitness::mean(values, n);
+					comp->adapt((double) successes / compared, mean, std::sqrt(Fitness::squaredDeviations(values, n, mean) / n));
+				}
+
+				if(m->schedule_chunk_size > 0 && !m->pipeline_chunk_size) {
+					comp->updateCostModel(m->cost_hint);
+				}
+
+				// Wait for the other competitors to finish mutating
+				m->whistle.wait();
+
+				// Wait for the referee to set up the next generation
+				m->wall.wait();
+			}
+			m->finishRun();
+		}
+	}
+
+	/**
+	 * Find the best chromosomes of the competitor's generation, these are kept as
+	 * the competitor's elites and offered to the hall of fame. Only the top of the
+	 * fitness is partitioned (nth_element) rather than sorting the whole fitness.
+	 * @param comp The competitor whose generation has been evaluated.
+	 * @param fitness The fitness of the competitor's population by index.
+	 * @param order Buffer for the indexes ordered by fitness, kept by the calling thread.
+	 */
+	void selectElites(boost::shared_ptr<Competitor<T > > comp, const double *fitness,
+		std::vector<unsigned int > &order) {
+		selectElites(comp, 0, comp->getPopulationSize(), fitness, order, comp->elites);
+	}
+
+	/**
+	 * Find the best chromosomes of a range of the competitor's generation, these
+	 * are kept as elites and offered to the hall of fame.
+	 * @param comp The competitor whose generation has been evaluated.
+	 * @param start_index The start of the range.
+	 * @param size The size of the range.
+	 * @param fitness The fitness of the competitor's population by index.
+	 * @param order Buffer for the indexes ordered by fitness, kept by the calling thread.
+	 * @param elites The output elites, best first.
+	 */
+	void selectElites(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index, unsigned int size,
+		const double *fitness, std::vector<unsigned int > &order, std::vector<Chromosome<T > > &elites) {
+
+		// The Pareto front takes the place of the hall of fame with multiple objectives.
+		unsigned int num_elites = std::min<unsigned int>(elitism, size);
+		unsigned int num_famous = objective_function ? 0 : hall_of_fame.getCapacity();
+		unsigned int num_best = std::min<unsigned int>(std::max<unsigned int>(num_elites, num_famous), size);
+		if(num_best == 0) {
+			elites.clear();
+			return;
+		}
+
+		order.resize(size);
+		for(unsigned int i = 0; i < size; i++) {
+			order[i] = start_index + i;
+		}
+		auto better = [fitness](unsigned int a, unsigned int b) { return fitness[a] > fitness[b]; };
+		std::nth_element(order.begin(), order.begin() + num_best, order.end(), better);
+		std::nth_element(order.begin(), order.begin() + num_elites, order.begin() + num_best, better);
+
+		// Assigning over the previous elites reuses their storage.
+		elites.resize(num_elites);
+		for(unsigned int i = 0; i < num_best; i++) {
+			Chromosome<T > &chromosome = comp->population.at(order[i]);
+			if(i < num_elites) {
+				elites[i] = chromosome;
+			}
+			// Only a fitness that has been evaluated goes into the hall of fame.
+			if(!objective_function && !comp->predicted[order[i]]) {
+				hall_of_fame.add(chromosome, fitness[order[i]]);
+			}
+		}
+	}
+
+	/**
+	 * Add a summary to a running summary, the mean and variance are combined
+	 * without going over the fitness again (Chan et al.).
+	 * @param total The running summary, starts value initialized.
+	 * @param summary The summary to add.
+	 */
+	void combine(SliceSummary &total, const SliceSummary &summary) {
+		total.sum+= summary.sum;
+		if(summary.n == 0) {
+			return;
+		}
+		if(total.n == 0 || summary.best > total.best) {
+			total.best = summary.best;
+		}
+		double delta = summary.mean - total.mean;
+		unsigned int combined = total.n + summary.n;
+		total.mean+= delta * summary.n / combined;
+		total.m2+= summary.m2 + delta * delta * ((double) total.n * summary.n / combined);
+		total.n = combined;
+	}
+
+	/**
+	 * Record the statistics of a generation and update the termination criteria with them.
+	 * @param total The summary of the fitness of the whole generation.
+	 * @param evaluations The evaluations of the fitness function the generation took.
+	 * @return Whether any of the criteria is met.
+	 */
+	bool record(const SliceSummary &total, unsigned long long evaluations) {
+
+		if(statistics.generation == 0) {
+			statistics.startup_time = (initialized_time - std::chrono::duration_cast<std::chrono::nanoseconds>(
+				start_time.time_since_epoch()).count()) / 1e9;
+		}
+		statistics.generation++;
+		statistics.best_fitness = total.best;
+		statistics.mean_fitness = total.mean;
+		statistics.fitness_deviation = total.n > 0 ? std::sqrt(total.m2 / total.n) : 0;
+		statistics.evaluations+= evaluations;
+		statistics.surrogate_predictions = surrogate.getPredictions();
+		statistics.surrogate_error = surrogate.getError();
+		unsigned long long local_evaluations = local_search_evaluations.exchange(0);
+		statistics.evaluations+= local_evaluations;
+		statistics.local_search_evaluations+= local_evaluations;
+		statistics.elapsed_time = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start_time).count();
+
+		// The competitors evaluate side by side so the generation takes as long as the longest.
+		if(schedule_chunk_size > 0 && !pipeline_chunk_size) {
+			double predicted = 0;
+			double actual = 0;
+			for(unsigned int i = 0; i < competitors.size(); i++) {
+				predicted = std::max(predicted, competitors[i]->getPredictedMakespan());
+				actual = std::max(actual, competitors[i]->getActualMakespan());
+			}
+			if(predicted > 0) {
+				statistics.predicted_makespan+= predicted;
+				statistics.actual_makespan+= actual;
+			}
+		}
+
+		unsigned long long allocations = AllocationCounter::count();
+		statistics.allocations = allocations - allocation_count;
+		allocation_count = allocations;
+
+		// Every criteria is updated each generation since some keep state between generations.
+		bool terminate = false;
+		for(unsigned int i = 0; i < termination_criteria.size(); i++) {
+			if(termination_criteria[i]->update(statistics)) {
+				terminate = true;
+			}
+		}
+		return terminate;
+	}
+
+	void referee(bool final=false) {
+
+		// Wait for the competitor threads to signal that their populations are ready.
+		whistle.wait();
+
+		// The master vectors keep their size between generations so the chromosomes
+		// are copied over the previous generation's storage.
+		unsigned int total = 0;
+		competitor_offsets.resize(competitors.size());
+		for(unsigned int i = 0; i < competitors.size(); i++) {
+			competitor_offsets[i] = total;
+			total+= competitors[i]->getPopulationSize();
+		}
+		master_values.resize(total);
+		master_costs.resize(total);
+		slice_summaries.resize(num_competitor * max_num_threads);
+		if(objective_function) {
+			master_objectives.resize(total);
+			pareto_order.resize(total);
+		} else {
+			rw.resize(total);
+		}
+
+		// The worker threads copy the fitness into the master vectors and build the
+		// selection table, see merge(). The chromosomes are read from the snapshot of
+		// each competitor's population rather than copied.
+		merge_wall.wait();
+		merge_wall.wait();
+		merge_wall.wait();
+
+		SliceSummary summary = SliceSummary();
+		for(unsigned int i = 0; i < slice_summaries.size(); i++) {
+			combine(summary, slice_summaries[i]);
+		}
+
+		if(objective_function) {
+			// The statistics are of the mean objectives, the master fitness is now replaced
+			// by the selection values which depend on every objective.
+			statistics.front_size = rankObjectives();
+			rw.init(master_values);
+		} else {
+			rw.finish(summary.sum);
+		}
+
+		// The chromosomes given a predicted fitness were not evaluated.
+		unsigned long long predictions = surrogate.getPredictions();
+		bool terminate = record(summary, summary.n - (predictions - surrogate_predictions));
+		surrogate_predictions = predictions;
+
+		if(final || terminate || solutions.size() > 0) {
+			done = true;
+		}
+
+		if(progress) {
+			progress(statistics);
+		}
+
+		// The evaluated generation becomes the snapshot the next generation is bred from.
+		for(unsigned int i = 0; i < competitors.size(); i++) {
+			competitors[i]->population.publish();
+		}
+
+		// The worker threads read the configuration once they pass the wall.
+		if(!tune_configurations.empty()) {
+			tune();
 		}
 
 		// Notify competitors that they are free to proceed.
 		wall.wait();
 	}
 
+	/**
+	 * Build the configurations the autotuning tries and start the run with the
+	 * first, called before the worker threads start the run.
+	 */
+	void startTuning() {
+		unsigned int smallest = competitors[0]->getPopulationSize();
+		for(unsigned int i = 1; i < competitors.size(); i++) {
+			smallest = std::min(smallest, competitors[i]->getPopulationSize());
+		}
+
+		std::vector<unsigned int > thread_counts;
+		for(unsigned int threads = 1; threads < max_num_threads; threads*= 2) {
+			thread_counts.push_back(threads);
+		}
+		thread_counts.push_back(max_num_threads);
+
+		for(unsigned int i = 0; i < thread_counts.size(); i++) {
+			// A chunk per thread is closest to each thread breeding its own range.
+			unsigned int chunk_sizes[] = {8, 32, 128, (smallest + thread_counts[i] - 1) / thread_counts[i]};
+			for(unsigned int j = 0; j < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); j++) {
+				bool tried = false;
+				for(unsigned int k = 0; k < tune_configurations.size(); k++) {
+					tried|= tune_configurations[k].threads == thread_counts[i] &&
+						tune_configurations[k].chunk_size == chunk_sizes[j];
+				}
+				if(chunk_sizes[j] <= smallest && !tried) {
+					TuneConfiguration configuration = {thread_counts[i], chunk_sizes[j]};
+					tune_configurations.push_back(configuration);
+				}
+			}
+		}
+
+		tuned = tune_configurations.front();
+		tuned_rate = 0;
+		tune_start_time = 0;
+		tune_start_evaluations = 0;
+		active_threads = tuned.threads;
+		pipeline_chunk_size = tuned.chunk_size;
+	}
+
+	/**
+	 * Time the configuration of the autotuning that is running and move on to the
+	 * next once it has run for its generations, or to the fastest once they have
+	 * all been tried. Called by the referee at the end of each generation.
+	 */
+	void tune() {
+		// The first generation also initializes the population, it is not timed.
+		if(statistics.generation == 1) {
+			tune_start_time = statistics.elapsed_time;
+			tune_start_evaluations = statistics.evaluations;
+			return;
+		}
+		if((statistics.generation - 1) % autotune_generations != 0) {
+			return;
+		}
+
+		double seconds = statistics.elapsed_time - tune_start_time;
+		double rate = seconds > 0 ? (statistics.evaluations - tune_start_evaluations) / seconds : 0;
+		if(rate > tuned_rate) {
+			tuned_rate = rate;
+			tuned = tune_configurations.front();
+		}
+		tune_start_time = statistics.elapsed_time;
+		tune_start_evaluations = statistics.evaluations;
+
+		tune_configurations.erase(tune_configurations.begin());
+		TuneConfiguration next = tune_configurations.empty() ? tuned : tune_configurations.front();
+		active_threads = next.threads;
+		pipeline_chunk_size = next.chunk_size;
+	}
+
+	/**
+	 * Merge a slice of the competitors' fitness into the master fitness, run by each
+	 * worker thread while the referee waits. The first phase copies the fitness of
+	 * the slice and sums its weights, the second phase writes the
+	 * slice's part of the selection table offset by the sum of the slices before it
+	 * (a scan over the slice sums).
+	 * @param slice The slice, the number of the worker thread.
+	 */
+	void merge(unsigned int slice) {
+
+		// Wait for the referee to size the master vectors.
+		merge_wall.wait();
+
+		unsigned int total = master_values.size();
+		unsigned int slices = slice_summaries.size();
+		unsigned int begin = (unsigned long long) total * slice / slices;
+		unsigned int end = (unsigned long long) total * (slice + 1) / slices;
+
+		for(unsigned int i = 0; i < competitors.size(); i++) {
+			unsigned int offset = competitor_offsets[i];
+			unsigned int from = std::max(begin, offset);
+			unsigned int to = std::min(end, offset + competitors[i]->getPopulationSize());
+
+			for(unsigned int k = from; k < to; k++) {
+				double value = competitors[i]->fitness_values[k - offset];
+				master_values[k] = value;
+				master_costs[k] = competitors[i]->costs[k - offset];
+			}
+
+			if(objective_function) {
+				for(unsigned int k = from; k < to; k++) {
+					master_objectives[k] = competitors[i]->objectives[k - offset];
+					pareto_order[k] = k;
+				}
+			}
+		}
+
+		SliceSummary &summary = slice_summaries[slice];
+		summarize(master_values.data() + begin, end - begin, summary);
+
+		// The referee merges the ordered slices and builds the fronts from them.
+		if(objective_function) {
+			Pareto::order(master_objectives, pareto_order.begin() + begin, pareto_order.begin() + end);
+		}
+
+		merge_wall.wait();
+
+		if(!objective_function) {
+			double upper_bound = 0;
+			for(unsigned int i = 0; i < slice; i++) {
+				upper_bound+= slice_summaries[i].sum;
+			}
+			for(unsigned int k = begin; k < end; k++) {
+				upper_bound+= rw.weight(master_values[k]);
+				rw.set(k, upper_bound, k);
+			}
+		}
+
+		merge_wall.wait();
+	}
+
+	/**
+	 * Summarize a range of fitness: the sum of its selection weights, the mean and
+	 * variance (two pass) and the best fitness.
+	 * @param values The fitness.
+	 * @param n The size of the range.
+	 * @param summary The output summary.
+	 */
+	void summarize(const double *values, unsigned int n, SliceSummary &summary) {
+		summary.sum = 0;
+		summary.n = n;
+		summary.mean = 0;
+		summary.m2 = 0;
+		summary.best = 0;
+		if(summary.n == 0) {
+			return;
+		}
+
+		double sum = Fitness::sum(values, summary.n);
+		summary.mean = sum / summary.n;
+		summary.m2 = Fitness::squaredDeviations(values, summary.n, summary.mean);
+		summary.best = Fitness::max(values, summary.n);
+		// The weight of a chromosome is its fitness plus a constant.
+		summary.sum = sum + (rw.weight(0) * summary.n);
+	}
+
+	/**
+	 * Replace the fitness of the master population with a selection value derived
+	 * from the non-dominated front and crowding distance of each chromosome (NSGA-II).
+	 * The value preserves the crowded comparison order: a lower front is always
+	 * better and within a front a larger crowding distance is better. The elites of
+	 * each competitor and the Pareto front are updated from the values.
+	 *
+	 * The lexicographic sort, the O(N log N) part of the non-dominated sort, has
+	 * been done on the slices by the worker threads in merge(). Placing the
+	 * chromosomes in the fronts and the crowding distance are left to this thread:
+	 * a chromosome's front depends on every front built before it, and splitting
+	 * the crowding distance would cost another barrier each generation.
+	 * @return The size of the generation's non-dominated front.
+	 */
+	unsigned int rankObjectives() {
+
+		unsigned int slices = slice_summaries.size();
+		unsigned int total = pareto_order.size();
+		for(unsigned int slice = 1; slice < slices; slice++) {
+			unsigned int middle = (unsigned long long) total * slice / slices;
+			unsigned int end = (unsigned long long) total * (slice + 1) / slices;
+			Pareto::merge(master_objectives, pareto_order.begin(), pareto_order.begin() + middle,
+				pareto_order.begin() + end);
+		}
+
+		std::vector<std::vector<unsigned int > > fronts;
+		std::vector<unsigned int > rank;
+		std::vector<double > distance;
+		Pareto::assign(master_objectives, pareto_order, fronts, rank);
+
+		for(unsigned int f = 0; f < fronts.size(); f++) {
+			Pareto::crowding(master_objectives, fronts[f], distance);
+
+			for(unsigned int j = 0; j < fronts[f].size(); j++) {
+				// Map the crowding distance [0, inf] to [0, 1]
+				double crowding = std::isinf(distance[fronts[f][j]]) ? 1.0 :
+					distance[fronts[f][j]] / (1.0 + distance[fronts[f][j]]);
+				master_values[fronts[f][j]] = (fronts.size() - f - 0.5 + 0.5 * crowding) / fronts.size();
+			}
+		}
+
+		unsigned int offset = 0;
+		std::vector<unsigned int > order;
+		for(unsigned int i = 0; i < competitors.size(); i++) {
+			selectElites(competitors[i], &master_values[offset], order);
+			offset+= competitors[i]->getPopulationSize();
+		}
+
+		if(fronts.empty()) {
+			return 0;
+		}
+		updateParetoFront(fronts[0]);
+		return fronts[0].size();
+	}
+
+	/**
+	 * Merge the non-dominated front of the generation into the Pareto front.
+	 * Duplicate chromosomes are dropped and if the front grows beyond its
+	 * maximum size the most crowded chromosomes are dropped.
+	 * @param front The indexes into the master population of the generation's front.
+	 */
+	void updateParetoFront(std::vector<unsigned int > &front) {
+
+		std::vector<Chromosome<T > > chromosomes(pareto_front);
+		std::vector<std::vector<double > > objectives(pareto_objectives);
+		for(unsigned int i = 0; i < front.size(); i++) {
+			unsigned int competitor = competitorOf(front[i]);
+			chromosomes.push_back(competitors[competitor]->population.at(front[i] - competitor_offsets[competitor]));
+			objectives.push_back(master_objectives[front[i]]);
+		}
+
+		std::vector<std::vector<unsigned int > > fronts;
+		std::vector<unsigned int > rank;
+		Pareto::sort(objectives, fronts, rank);
+
+		std::vector<unsigned int > kept;
+		std::unordered_multimap<std::size_t, unsigned int > seen;
+		for(unsigned int i = 0; i < fronts[0].size(); i++) {
+			unsigned int index = fronts[0][i];
+			std::size_t hash = chromosomes[index].hash();
+			bool duplicate = false;
+			auto range = seen.equal_range(hash);
+			for(auto it = range.first; it != range.second && !duplicate; ++it) {
+				duplicate = chromosomes[it->second] == chromosomes[index];
+			}
+			if(!duplicate) {
+				seen.insert(std::make_pair(hash, index));
+				kept.push_back(index);
+			}
+		}
+
+		if(kept.size() > max_pareto_size) {
+			std::vector<double > distance;
+			Pareto::crowding(objectives, kept, distance);
+			std::nth_element(kept.begin(), kept.begin() + max_pareto_size, kept.end(),
+				[&distance](unsigned int a, unsigned int b) { return distance[a] > distance[b]; });
+			kept.resize(max_pareto_size);
+		}
+
+		pareto_front.clear();
+		pareto_objectives.clear();
+		for(unsigned int i = 0; i < kept.size(); i++) {
+			pareto_front.push_back(chromosomes[kept[i]]);
+			pareto_objectives.push_back(objectives[kept[i]]);
+		}
+	}
+
+	/**
+	 * Find the competitor a chromosome of the master population belongs to.
+	 * @param index The index of the chromosome in the master population.
+	 * @return The index of the competitor.
+	 */
+	unsigned int competitorOf(unsigned int index) {
+		return std::upper_bound(competitor_offsets.begin(), competitor_offsets.end(), index) -
+			competitor_offsets.begin() - 1;
+	}
+
+	/**
+	 * Get a chromosome of the master population from the snapshot of its competitor,
+	 * the last generation. The snapshot is not changed while the next generation is bred.
+	 * @param index The index of the chromosome in the master population.
+	 * @return The chromosome.
+	 */
+	const Chromosome<T > &parent(unsigned int index) {
+		unsigned int competitor = competitorOf(index);
+		return competitors[competitor]->population.snapshot()[index - competitor_offsets[competitor]];
+	}
+
+	/**
+	 * Whether the worker threads run the cellular mode on their own tiles, see setCellular.
+	 */
+	bool tiled() {
+		return cellular && !objective_function;
+	}
+
+	/**
+	 * Get the width of a competitor's grid in the cellular mode.
+	 * @param size The size of the competitor's population.
+	 */
+	unsigned int gridWidth(unsigned int size) {
+		return grid_width > 0 ? std::min(grid_width, size) :
+			std::max(1u, static_cast<unsigned int >(std::sqrt(size)));
+	}
+
+	/**
+	 * Get the von Neumann neighbourhood of a cell of a competitor's grid. The
+	 * neighbours wrap around the edges, a partial last row wraps onto the first cells.
+	 * @param cell The cell.
+	 * @param width The width of the grid.
+	 * @param size The number of cells of the grid.
+	 * @param neighbours The output cells above, below, left and right of the cell.
+	 */
+	static void cellNeighbours(unsigned int cell, unsigned int width, unsigned int size, unsigned int neighbours[4]) {
+		unsigned int rows = (size + width - 1) / width;
+		unsigned int row = cell / width;
+		unsigned int column = cell % width;
+		neighbours[0] = (((row + rows - 1) % rows) * width + column) % size;
+		neighbours[1] = (((row + 1) % rows) * width + column) % size;
+		neighbours[2] = (row * width + (column + width - 1) % width) % size;
+		neighbours[3] = (row * width + (column + 1) % width) % size;
+	}
+
+	/**
+	 * Get the tile a cell of a competitor's grid belongs to, the tiles are the
+	 * ranges of the worker threads of the competitor.
+	 * @param cell The cell.
+	 * @param size The number of cells of the grid.
+	 * @return The tile, counted from the competitor's first tile.
+	 */
+	unsigned int tileOf(unsigned int cell, unsigned int size) {
+		// The last worker thread also takes the remainder of the population.
+		unsigned int tile_size = size / max_num_threads;
+		return tile_size == 0 ? max_num_threads - 1 : std::min(cell / tile_size, max_num_threads - 1);
+	}
+
+	/**
+	 * Find the tiles that share cells with a tile: the tiles its halo is read from
+	 * and the tiles that read it as their halo.
+	 * @param comp The competitor.
+	 * @param tile The tile, the number of its worker thread.
+	 * @param neighbours The output tiles.
+	 */
+	void tileNeighbours(boost::shared_ptr<Competitor<T > > comp, unsigned int tile,
+		std::vector<unsigned int > &neighbours) {
+
+		unsigned int size = comp->getPopulationSize();
+		unsigned int width = gridWidth(size);
+		unsigned int first = tile - tile % max_num_threads;
+		std::vector<char > shared(max_num_threads, false);
+		unsigned int cells[4];
+		for(unsigned int cell = 0; cell < size; cell++) {
+			unsigned int owner = first + tileOf(cell, size);
+			cellNeighbours(cell, width, size, cells);
+			for(unsigned int i = 0; i < 4; i++) {
+				unsigned int other = first + tileOf(cells[i], size);
+				if(owner == tile && other != tile) {
+					shared[other - first] = true;
+				} else if(other == tile && owner != tile) {
+					shared[owner - first] = true;
+				}
+			}
+		}
+
+		neighbours.clear();
+		for(unsigned int i = 0; i < max_num_threads; i++) {
+			if(shared[i]) {
+				neighbours.push_back(first + i);
+			}
+		}
+	}
+
+	/**
+	 * Wait for the tiles next to a tile to reach a generation.
+	 * @param flags The flags of the tiles.
+	 * @param neighbours The tiles.
+	 * @param generations The number of generations.
+	 * @return Whether they reached it, false once the run is over.
+	 */
+	bool waitTiles(EpochFlags &flags, const std::vector<unsigned int > &neighbours, unsigned int generations) {
+		for(unsigned int i = 0; i < neighbours.size(); i++) {
+			if(!flags.wait(neighbours[i], generations)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Run the generations of a worker thread's tile in the cellular mode, see
+	 * setCellular. The tile is evaluated, reported and bred without a barrier
+	 * over the other threads, the fitness is kept in the competitor's fitness
+	 * values and read from there by the tiles next to it.
+	 * @param comp The competitor.
+	 * @param start_index The first cell of the tile.
+	 * @param problem_size The number of cells of the tile.
+	 * @param tile The tile, the number of the worker thread.
+	 * @param results Buffer for the fitness of the tile, kept by the calling thread.
+	 * @param sub_population Buffer for the bred chromosomes, kept by the calling thread.
+	 * @param parent_fitness Buffer for the fitness of their parents, kept by the calling thread.
+	 * @param parent_cost Buffer for the evaluation cost of their parents, kept by the calling thread.
+	 * @param buffers The buffers of the calling thread.
+	 * @param arena The arena of the calling thread, reset each generation.
+	 * @param engine The random number generator of the calling thread.
+	 * @param counters The hardware counters of the calling thread.
+	 * @param phases The counts of each phase of the calling thread.
+	 */
+	void runTile(boost::shared_ptr<Competitor<T > > comp, unsigned int start_index, unsigned int problem_size,
+		unsigned int tile, std::vector<Result > &results, std::vector<Chromosome<T > > &sub_population,
+		std::vector<double > &parent_fitness, std::vector<double > &parent_cost, EvaluationBuffers &buffers,
+		GenerationArena &arena, std::mt19937 &engine, PerfCounters &counters, PhaseCounts *phases) {
+
+		std::vector<unsigned int > neighbours;
+		tileNeighbours(comp, tile, neighbours);
+
+		std::vector<unsigned int > order;
+		std::vector<Chromosome<T > > elites;
+		unsigned int tiles = num_competitor * max_num_threads;
+
+		comp->initPopulation(start_index, problem_size, chromosome_size, engine, seeds, seeded(comp), generator);
+		markInitialized();
+
+		for(unsigned int generation = 0; ; generation++) {
+
+			// Nothing allocated in the last generation is still in use.
+			arena.reset();
+
+			counters.start();
+			evaluate(comp, start_index, problem_size, results, buffers);
+			counters.stop(phases[EVALUATION_PHASE]);
+
+			// The report replaces the one a window of generations ago once its statistics are gathered.
+			if(generation >= TILE_WINDOW && !tile_reduced.wait(0, generation - TILE_WINDOW + 1)) {
+				break;
+			}
+
+			counters.start();
+			TileReport &report = tile_reports[(generation % TILE_WINDOW) * tiles + tile];
+			report.evaluations = 0;
+			report.compared = 0;
+			report.successes = 0;
+			for(unsigned int i = 0; i < results.size(); i++) {
+				unsigned int index = results[i].getIndex();
+				double value = results[i].getResult();
+				comp->fitness_values[index] = value;
+				if(value == 1.0) {
+					solutions.insert(comp->population.at(index));
+				}
+				double parent = comp->parent_fitness[index];
+				if(!std::isnan(parent)) {
+					report.compared++;
+					if(value > parent) {
+						report.successes++;
+					}
+				}
+			}
+			results.clear();
+			for(unsigned int i = start_index; i < start_index + problem_size; i++) {
+				report.evaluations+= !comp->predicted[i];
+			}
+			summarize(comp->fitness_values.data() + start_index, problem_size, report.summary);
+			{
+				// The elites are kept beyond the generation.
+				ArenaScope heap(NULL);
+				selectElites(comp, start_index, problem_size, comp->fitness_values.data(), order, elites);
+			}
+			counters.stop(phases[SELECTION_PHASE]);
+			tile_evaluated.set(tile, generation + 1);
+
+			if(done || generation + 1 >= max_generation_number) {
+				break;
+			}
+
+			// Breed from the generation once the tiles next to it have evaluated theirs.
+			if(!waitTiles(tile_evaluated, neighbours, generation + 1)) {
+				break;
+			}
+
+			counters.start();
+			for(unsigned int i = 0; i < elites.size(); i++) {
+				sub_population.push_back(elites[i]);
+				parent_fitness.push_back(std::numeric_limits<double >::quiet_NaN());
+				parent_cost.push_back(std::numeric_limits<double >::quiet_NaN());
+			}
+			breedCells(comp, comp->population.current(), comp->fitness_values.data(), comp->costs.data(),
+				start_index, problem_size, sub_population, parent_fitness, parent_cost, engine);
+			counters.stop(phases[BREEDING_PHASE]);
+			tile_bred.set(tile, generation + 1);
+
+			// The tile is overwritten once the tiles next to it have bred from it.
+			if(!waitTiles(tile_bred, neighbours, generation + 1)) {
+				break;
+			}
+
+			comp->population.copy(start_index, sub_population);
+			std::copy(parent_fitness.begin(), parent_fitness.end(), comp->parent_fitness.begin() + start_index);
+			std::copy(parent_cost.begin(), parent_cost.end(), comp->expected_costs.begin() + start_index);
+			sub_population.clear();
+			parent_fitness.clear();
+			parent_cost.clear();
+		}
+
+		sub_population.clear();
+		parent_fitness.clear();
+		parent_cost.clear();
+	}
+
+	/**
+	 * Gather the statistics of the generations of the cellular mode from the
+	 * reports of the tiles as they come in, the tiles do not wait for it unless
+	 * they are a whole window of generations ahead. The rates of each competitor
+	 * are adapted from the reports of its tiles.
+	 * @return The number of generations run.
+	 */
+	unsigned int reduceTiles() {
+
+		unsigned int tiles = num_competitor * max_num_threads;
+		unsigned int generation;
+		for(generation = 0; generation < max_generation_number && !done; generation++) {
+			TileReport *reports = &tile_reports[(generation % TILE_WINDOW) * tiles];
+
+			SliceSummary summary = SliceSummary();
+			unsigned long long evaluations = 0;
+			for(unsigned int i = 0; i < competitors.size(); i++) {
+				SliceSummary competitor_summary = SliceSummary();
+				unsigned int compared = 0;
+				unsigned int successes = 0;
+				for(unsigned int tile = i * max_num_threads; tile < (i + 1) * max_num_threads; tile++) {
+					tile_evaluated.wait(tile, generation + 1);
+					combine(competitor_summary, reports[tile].summary);
+					evaluations+= reports[tile].evaluations;
+					compared+= reports[tile].compared;
+					successes+= reports[tile].successes;
+				}
+				combine(summary, competitor_summary);
+
+				// The first generation has no parents to compare against.
+				if(compared > 0) {
+					competitors[i]->adapt((double) successes / compared, competitor_summary.mean,
+						std::sqrt(competitor_summary.m2 / competitor_summary.n));
+				}
+			}
+
+			bool terminate = record(summary, evaluations);
+			if(generation + 1 == max_generation_number || terminate || solutions.size() > 0) {
+				done = true;
+			}
+
+			if(progress) {
+				progress(statistics);
+			}
+
+			// The reports of the generation can be replaced.
+			tile_reduced.set(0, generation + 1);
+		}
+
+		// Wake the tiles waiting on the tiles that have stopped.
+		tile_evaluated.close();
+		tile_bred.close();
+		tile_reduced.close();
+		return generation;
+	}
+
+	/**
+	 * Breed a tile of a competitor's grid in the cellular mode, see setCellular.
+	 * @param comp The competitor.
+	 * @param grid The evaluated generation of the competitor.
+	 * @param fitness The fitness of each cell of the grid.
+	 * @param cost The evaluation cost of each cell of the grid.
+	 * @param start_index The first cell of the tile.
+	 * @param problem_size The number of cells of the tile.
+	 * @param new_population The bred chromosomes, chromosomes already within it (the
+	 * elites) take the first cells of the tile.
+	 * @param parent_fitness The fitness of the best parent of each chromosome bred
+	 * is appended to this.
+	 * @param parent_cost The mean evaluation cost of the parents of each chromosome
+	 * bred is appended to this.
+	 * @param engine The random number generator of the calling thread.
+	 */
+	void breedCells(boost::shared_ptr<Competitor<T > > comp, const std::vector<Chromosome<T > > &grid,
+		const double *fitness, const double *cost, unsigned int start_index, unsigned int problem_size,
+		std::vector<Chromosome<T> > &new_population, std::vector<double > &parent_fitness,
+		std::vector<double > &parent_cost, std::mt19937 &engine) {
+
+		unsigned int size = grid.size();
+		unsigned int width = gridWidth(size);
+
+		std::uniform_real_distribution<float> operation_dist(op_dist.param());
+		std::uniform_int_distribution<unsigned int> neighbour_dist(0, 3);
+		double mutation_rate = comp->getMutationRate();
+		double crossover_rate = comp->getCrossoverRate();
+
+		unsigned int neighbours[4];
+		for(unsigned int cell = start_index + new_population.size(); cell < start_index + problem_size; cell++) {
+			cellNeighbours(cell, width, size, neighbours);
+
+			unsigned int first = neighbours[neighbour_dist(engine)];
+			unsigned int second = neighbours[neighbour_dist(engine)];
+			unsigned int mate = fitness[second] > fitness[first] ? second : first;
+
+			if(operation_dist(engine) <= crossover_rate && mate != cell) {
+				// Only the first child, which keeps the start of the cell's chromosome, is used.
+				grid[cell].crossover(grid[mate], new_population, engine, crossover_type);
+				new_population.pop_back();
+				parent_fitness.push_back(std::max(fitness[cell], fitness[mate]));
+				parent_cost.push_back((cost[cell] + cost[mate]) / 2);
+			} else {
+				grid[cell].cloning(new_population);
+				parent_fitness.push_back(fitness[cell]);
+				parent_cost.push_back(cost[cell]);
+			}
+
+			mutate(new_population.back(), mutation_rate, engine);
+		}
+	}
+
 	/**
 	 * Prepare the population for the next generation by apply the genetic operations.
+	 * @param new_population The new population, chromosomes already within it (the
+	 * elites) are kept and the remainder up to problem_size is bred.
+	 * @param parent_fitness The fitness of the best parent of each chromosome bred
+	 * is appended to this.
+	 * @param parent_cost The mean evaluation cost of the parents of each chromosome
+	 * bred is appended to this.
+	 * @param engine The random number generator of the calling thread.
 	 */
-	std::vector<Chromosome<T> > breed(unsigned int population_size, double mutation_rate,
-		double crossover_rate, unsigned int problem_size) {
+	void breed(std::vector<Chromosome<T> > &new_population, std::vector<double > &parent_fitness,
+		std::vector<double > &parent_cost, double mutation_rate, double crossover_rate, unsigned int problem_size, std::mt19937 &engine) {
 
-		std::vector<Chromosome<T> > new_population;
+		std::uniform_real_distribution<float> operation_dist(op_dist.param());
 
 		// Iterate through the chromosomes
 		//while(new_population.size() < population_size) {
 		while(new_population.size() < problem_size) {
 			// Use a random number between to identify which operation to apply (each operation gets a slice of the range)
-			float selected_operation = op_dist(rand_engine);
-			unsigned int selected_chromosome = rw.next();
+			float selected_operation = operation_dist(engine);
+			unsigned int selected_chromosome = rw.next(engine);
 
 			if(selected_operation <= crossover_rate) {
 				// Crossover
-				unsigned int other_selected_chromosome = rw.next();
+				unsigned int other_selected_chromosome = rw.next(engine);
 
 				// If the chromosome selected are the same than there is no point apply the crossover.
 				if(other_selected_chromosome != selected_chromosome) {
-					master_population.at(selected_chromosome).crossover(master_population.at(other_selected_chromosome), new_population);
+					parent(selected_chromosome).crossover(parent(other_selected_chromosome), new_population, engine,
+						crossover_type);
 				} else {
-					master_population.at(selected_chromosome).cloning(new_population);
-					master_population.at(other_selected_chromosome).cloning(new_population);
+					parent(selected_chromosome).cloning(new_population);
+					parent(other_selected_chromosome).cloning(new_population);
 				}
 
 				// Mutate the second chromosome in the crossover
-				mutate((*(new_population.end() - 2)), mutation_rate);
+				mutate((*(new_population.end() - 2)), mutation_rate, engine);
+
+				double best_parent = std::max(master_values[selected_chromosome], master_values[other_selected_chromosome]);
+				parent_fitness.push_back(best_parent);
+				parent_fitness.push_back(best_parent);
+
+				double mean_cost = (master_costs[selected_chromosome] + master_costs[other_selected_chromosome]) / 2;
+				parent_cost.push_back(mean_cost);
+				parent_cost.push_back(mean_cost);
 
 				// Handle the case where the new_master_population.size() -1 == master_population size and then crossover is selected.
 				if(new_population.size() == problem_size+1) {
 					new_population.pop_back();
+					parent_fitness.pop_back();
+					parent_cost.pop_back();
 				}
 			}
 			else {
 				// Clone
-                master_population.at(selected_chromosome).cloning(new_population);
+                parent(selected_chromosome).cloning(new_population);
+				parent_fitness.push_back(master_values[selected_chromosome]);
+				parent_cost.push_back(master_costs[selected_chromosome]);
 			}
 
 			// Mutate the chromosome
-			mutate(new_population.back(), mutation_rate);
+			mutate(new_population.back(), mutation_rate, engine);
 
 		}
-
-		// Update the population to the new population
-		return new_population;
 	}
 };
 
+template<class T>
+const unsigned int Manager<T >::MAX_OBJECTIVES;
 
 #endif /* MANAGER_HPP_ */
@@ -0,0 +1,145 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MANAGER_CACHE_HPP_
+#define MANAGER_CACHE_HPP_
+
+#include <list>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "Manager.hpp"
+
+/**
+ * The idle Managers of the service mode. A job takes a Manager of its shape
+ * (the population sizes, chromosome size and range, competitors and threads)
+ * from the cache when there is one, so it reuses the parked threads of a
+ * finished job instead of creating its own, and gives it back once the run is
+ * over. Only a few Managers are kept, the least recently used is destroyed.
+ */
+template <class T>
+class ManagerCache {
+
+public:
+
+	/**
+	 * What a Manager is created with that can not be changed afterwards.
+	 */
+	struct Shape {
+		std::vector<unsigned int > population_sizes;
+		unsigned int chromosome_size;
+		T max_value;
+		T min_value;
+		unsigned int num_competitor;
+		unsigned int num_threads;
+
+		bool operator==(const Shape &other) const {
+			return population_sizes == other.population_sizes && chromosome_size == other.chromosome_size &&
+				max_value == other.max_value && min_value == other.min_value &&
+				num_competitor == other.num_competitor && num_threads == other.num_threads;
+		}
+	};
+
+private:
+
+	struct Entry {
+		Shape shape;
+		boost::shared_ptr<Manager<T > > manager;
+	};
+
+	// The most recently given back first.
+	std::list<Entry > idle;
+	unsigned int max_idle;
+	boost::mutex mtx_;
+
+public:
+
+	/**
+	 * Create an empty cache.
+	 * @param max_idle The most idle Managers kept.
+	 */
+	ManagerCache(unsigned int max_idle=4) : max_idle(max_idle) {
+	}
+
+	~ManagerCache() {
+	}
+
+	/**
+	 * Take an idle Manager of the shape, reset to the settings of a new Manager
+	 * (see Manager::reset), or create one when there is none.
+	 * @param shape The shape of the Manager.
+	 * @param max_generation_number The maximum number of generations.
+	 * @param mutation_rates The mutation rate of each competitor.
+	 * @param crossover_rates The crossover rate of each competitor.
+	 * @return The Manager, give it back with give() once the run is over.
+	 */
+	boost::shared_ptr<Manager<T > > take(const Shape &shape, unsigned int max_generation_number,
+		std::vector<double > mutation_rates, std::vector<double > crossover_rates) {
+
+		boost::shared_ptr<Manager<T > > manager;
+		{
+			boost::unique_lock<boost::mutex> lock(mtx_);
+			for(typename std::list<Entry >::iterator it = idle.begin(); it != idle.end(); ++it) {
+				if(it->shape == shape) {
+					manager = it->manager;
+					idle.erase(it);
+					break;
+				}
+			}
+		}
+
+		if(manager) {
+			manager->reset(max_generation_number, mutation_rates, crossover_rates);
+		} else {
+			manager.reset(new Manager<T >(shape.population_sizes, shape.chromosome_size, max_generation_number,
+				shape.max_value, shape.min_value, mutation_rates, crossover_rates, shape.num_competitor,
+				shape.num_threads));
+		}
+		return manager;
+	}
+
+	/**
+	 * Give a Manager taken from the cache back once its run is over.
+	 * @param shape The shape the Manager was taken with.
+	 * @param manager The Manager.
+	 */
+	void give(const Shape &shape, boost::shared_ptr<Manager<T > > manager) {
+		Entry entry = {shape, manager};
+		boost::shared_ptr<Manager<T > > evicted;
+		{
+			boost::unique_lock<boost::mutex> lock(mtx_);
+			idle.push_front(entry);
+			if(idle.size() > max_idle) {
+				evicted = idle.back().manager;
+				idle.pop_back();
+			}
+		}
+		// Destroying the Manager joins its threads, which is not done holding the lock.
+		evicted.reset();
+	}
+};
+
+#endif /* MANAGER_CACHE_HPP_ */
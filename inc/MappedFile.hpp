@@ -22,35 +22,50 @@
  * SOFTWARE.
  */
 
-#include "Result.hpp"
+#ifndef MAPPED_FILE_HPP_
+#define MAPPED_FILE_HPP_
 
+#include <string>
+#include <cstddef>
 
-Result::Result() {
-	this->index = 0;
-	this->result = 0;
-}
+/**
+ * A read only memory mapping of a whole file, large files are paged in as they
+ * are read rather than copied into memory first.
+ */
+class MappedFile {
+
+	const char *memory;
+	std::size_t length;
+	bool open;
+
+public:
+
+	/**
+	 * Map a file.
+	 * @param path The path of the file.
+	 */
+	MappedFile(const std::string &path);
 
-Result::Result(unsigned int index, double result) {
-	this->index = index;
-	this->result = result;
-}
+	~MappedFile();
 
-unsigned int Result::getIndex() {
-	return index;
-}
+	/**
+	 * Whether the file could be opened, an empty file is open but has no data.
+	 */
+	bool isOpen() {
+		return open;
+	}
 
-void Result::setIndex(unsigned int index) {
-	this->index = index;
-}
+	const char *data() {
+		return memory;
+	}
 
-void Result::offsetIndex(unsigned int offset) {
-	this->index += offset;
-}
+	std::size_t size() {
+		return length;
+	}
 
-double Result::getResult() {
-	return result;
-}
+private:
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+};
 
-void Result::setResult(double result) {
-	this->result = result;
-}
+#endif /* MAPPED_FILE_HPP_ */
@@ -0,0 +1,108 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PARETO_HPP_
+#define PARETO_HPP_
+
+#include <vector>
+
+/**
+ * Non-dominated sorting and crowding distance used by the multi-objective
+ * (NSGA-II) mode. All objectives are maximized, like the fitness.
+ */
+class Pareto {
+public:
+
+	/**
+	 * Whether the first objective vector dominates the second, that is it is no
+	 * worse in every objective and better in at least one.
+	 * @param a The first objective vector.
+	 * @param b The second objective vector.
+	 * @return Whether a dominates b.
+	 */
+	static bool dominates(const std::vector<double > &a, const std::vector<double > &b);
+
+	/**
+	 * Assign each objective vector to its non-dominated front. This is the
+	 * efficient non-dominated sort with binary search (ENS-BS): the vectors are
+	 * sorted lexicographically so a vector can only be dominated by the vectors
+	 * before it, then each vector is placed in the first front that does not
+	 * dominate it found by a binary search over the fronts. With two objectives
+	 * only the last member of a front has to be checked giving O(N log N).
+	 *
+	 * @param objectives The objective vector of each individual.
+	 * @param fronts The output fronts, each a list of indexes into objectives,
+	 * fronts[0] is the non-dominated front.
+	 * @param rank The output front of each individual.
+	 */
+	static void sort(const std::vector<std::vector<double > > &objectives,
+		std::vector<std::vector<unsigned int > > &fronts, std::vector<unsigned int > &rank);
+
+	/**
+	 * Order a range of indexes lexicographically, best first, the order the
+	 * vectors are placed in the fronts. Ordered ranges can be sorted by
+	 * separate threads and merged with merge().
+	 * @param objectives The objective vector of each individual.
+	 * @param first The start of the indexes.
+	 * @param last The end of the indexes.
+	 */
+	static void order(const std::vector<std::vector<double > > &objectives,
+		std::vector<unsigned int >::iterator first, std::vector<unsigned int >::iterator last);
+
+	/**
+	 * Merge two consecutive ranges of indexes ordered by order().
+	 * @param objectives The objective vector of each individual.
+	 * @param first The start of the first range.
+	 * @param middle The end of the first range and the start of the second.
+	 * @param last The end of the second range.
+	 */
+	static void merge(const std::vector<std::vector<double > > &objectives,
+		std::vector<unsigned int >::iterator first, std::vector<unsigned int >::iterator middle,
+		std::vector<unsigned int >::iterator last);
+
+	/**
+	 * Assign each objective vector to its non-dominated front, the second half
+	 * of sort() for indexes that have already been ordered.
+	 * @param objectives The objective vector of each individual.
+	 * @param order Every index into objectives ordered by order().
+	 * @param fronts The output fronts.
+	 * @param rank The output front of each individual.
+	 */
+	static void assign(const std::vector<std::vector<double > > &objectives, const std::vector<unsigned int > &order,
+		std::vector<std::vector<unsigned int > > &fronts, std::vector<unsigned int > &rank);
+
+	/**
+	 * Calculate the crowding distance of the members of a front. The boundary
+	 * members of each objective get an infinite distance.
+	 *
+	 * @param objectives The objective vector of each individual.
+	 * @param front The indexes of the members of the front.
+	 * @param distance The crowding distance, indexed like objectives. Only the
+	 * members of the front are set.
+	 */
+	static void crowding(const std::vector<std::vector<double > > &objectives,
+		const std::vector<unsigned int > &front, std::vector<double > &distance);
+};
+
+#endif /* PARETO_HPP_ */
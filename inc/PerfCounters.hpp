@@ -0,0 +1,119 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PERFCOUNTERS_HPP_
+#define PERFCOUNTERS_HPP_
+
+/**
+ * The hardware events counted for each phase of a generation.
+ */
+enum CounterEvent {
+	CYCLES,
+	INSTRUCTIONS,
+	LLC_MISSES,
+	BRANCH_MISSES,
+	NUM_COUNTER_EVENTS
+};
+
+/**
+ * The phases of a generation the hardware events are counted for.
+ * EVALUATION_PHASE is the fitness (and local search) of the worker threads,
+ * SELECTION_PHASE the merge of the fitness into the selection table,
+ * BREEDING_PHASE the parent selection and genetic operators of the worker
+ * threads and REFEREE_PHASE the statistics and termination of the referee.
+ */
+enum GenerationPhase {
+	EVALUATION_PHASE,
+	SELECTION_PHASE,
+	BREEDING_PHASE,
+	REFEREE_PHASE,
+	NUM_GENERATION_PHASES
+};
+
+/**
+ * The hardware events counted over a phase, summed over the threads.
+ */
+struct PhaseCounts {
+	unsigned long long counts[NUM_COUNTER_EVENTS];
+
+	PhaseCounts();
+
+	PhaseCounts &operator+=(const PhaseCounts &other);
+};
+
+/**
+ * The hardware performance counters of the calling thread, read with
+ * perf_event_open on Linux. Counters that can not be opened (no PMU in a virtual
+ * machine, perf_event_paranoid, other platforms) are left out and count nothing,
+ * so the counters can always be started and stopped.
+ */
+class PerfCounters {
+
+	int fds[NUM_COUNTER_EVENTS];
+	unsigned long long start_counts[NUM_COUNTER_EVENTS];
+
+public:
+
+	PerfCounters();
+
+	~PerfCounters();
+
+	/**
+	 * Open the counters for the calling thread, only user space is counted.
+	 * @return The events that could be counted, a bit for each CounterEvent.
+	 */
+	unsigned int open();
+
+	/**
+	 * Start counting a phase.
+	 */
+	void start();
+
+	/**
+	 * Stop counting a phase.
+	 * @param counts The events since start() are added to this.
+	 */
+	void stop(PhaseCounts &counts);
+
+	/**
+	 * Get the name of an event for the run report.
+	 * @param event The event.
+	 */
+	static const char *name(CounterEvent event);
+
+	/**
+	 * Get the name of a phase for the run report.
+	 * @param phase The phase.
+	 */
+	static const char *name(GenerationPhase phase);
+
+private:
+
+	PerfCounters(const PerfCounters &);
+	PerfCounters &operator=(const PerfCounters &);
+
+	void read(unsigned long long *counts);
+};
+
+#endif /* PERFCOUNTERS_HPP_ */
@@ -0,0 +1,239 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef POPULATION_FILE_HPP_
+#define POPULATION_FILE_HPP_
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>		// memcmp, memcpy
+#include <algorithm>	// min
+#include <cmath>		// floor
+#include <type_traits>	// is_integral
+
+#include "Chromosome.hpp"
+#include "MappedFile.hpp"
+
+/**
+ * Reads and writes populations, used to seed the initial population of a run
+ * with the result of a previous run (see Manager::setSeeds).
+ *
+ * Two formats are read. The binary format is a PopulationHeader followed by the
+ * elements of each chromosome, it is what save writes. Any other file is read as
+ * CSV, one chromosome per line with its elements separated by commas, empty lines
+ * and lines starting with # are skipped. Files are memory mapped so large
+ * populations are not copied before they are parsed.
+ */
+struct PopulationHeader {
+	char magic[8];
+	// The size in bytes of an element and the number of elements of each chromosome.
+	unsigned int element_size;
+	unsigned int chromosome_size;
+	unsigned long long count;
+};
+
+template <class T>
+class PopulationFile {
+
+	static constexpr const char *MAGIC = "GAPOP01";
+
+public:
+
+	/**
+	 * Read the chromosomes of a population file.
+	 * @param path The path of the file.
+	 * @param chromosome_size The size of the chromosomes.
+	 * @param min_value The smallest value of an element.
+	 * @param max_value The largest value of an element.
+	 * @param population The chromosomes are appended to this.
+	 * @return Whether the file was read, false if it could not be opened, a
+	 * chromosome does not have the size or an element is outside the range.
+	 */
+	static bool load(const std::string &path, unsigned int chromosome_size, T min_value, T max_value,
+		std::vector<Chromosome<T > > &population) {
+
+		MappedFile file(path);
+		if(!file.isOpen()) {
+			return false;
+		}
+
+		if(file.size() >= sizeof(PopulationHeader) && std::memcmp(file.data(), MAGIC, sizeof(((PopulationHeader *) 0)->magic)) == 0) {
+			return loadBinary(file, chromosome_size, min_value, max_value, population);
+		}
+		return loadCSV(file, chromosome_size, min_value, max_value, population);
+	}
+
+	/**
+	 * Write chromosomes in the binary format, e.g. the hall of fame of a run.
+	 * Shorter chromosomes are padded with default elements to the size of the longest.
+	 * @param path The path of the file.
+	 * @param population The chromosomes.
+	 * @return Whether the file was written.
+	 */
+	static bool save(const std::string &path, std::vector<Chromosome<T > > &population) {
+
+		PopulationHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MAGIC, std::strlen(MAGIC));
+		header.element_size = sizeof(T);
+		header.chromosome_size = 0;
+		header.count = population.size();
+		for(unsigned int i = 0; i < population.size(); i++) {
+			header.chromosome_size = std::max(header.chromosome_size, population[i].size());
+		}
+
+		std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+		std::vector<T > row(header.chromosome_size);
+		for(unsigned int i = 0; i < population.size(); i++) {
+			std::fill(row.begin(), row.end(), T());
+			for(unsigned int j = 0; j < population[i].size(); j++) {
+				row[j] = population[i][j];
+			}
+			file.write(reinterpret_cast<const char *>(row.data()), row.size() * sizeof(T));
+		}
+		return file.good();
+	}
+
+private:
+
+	static bool loadBinary(MappedFile &file, unsigned int chromosome_size, T min_value, T max_value,
+		std::vector<Chromosome<T > > &population) {
+
+		PopulationHeader header;
+		std::memcpy(&header, file.data(), sizeof(header));
+		std::size_t row_size = (std::size_t) header.chromosome_size * sizeof(T);
+		if(header.element_size != sizeof(T) || header.chromosome_size != chromosome_size ||
+			(file.size() - sizeof(header)) / std::max(row_size, (std::size_t) 1) < header.count) {
+			return false;
+		}
+
+		// The rows are copied out since the mapping has no alignment guarantee past the header.
+		const char *rows = file.data() + sizeof(header);
+		population.reserve(population.size() + header.count);
+		for(unsigned long long i = 0; i < header.count; i++) {
+			Chromosome<T > chromosome(chromosome_size);
+			for(unsigned int j = 0; j < chromosome_size; j++) {
+				std::memcpy(&chromosome[j], rows + i * row_size + j * sizeof(T), sizeof(T));
+				if(!(chromosome[j] >= min_value && chromosome[j] <= max_value)) {
+					return false;
+				}
+			}
+			population.push_back(chromosome);
+		}
+		return true;
+	}
+
+	static bool loadCSV(MappedFile &file, unsigned int chromosome_size, T min_value, T max_value,
+		std::vector<Chromosome<T > > &population) {
+
+		const char *position = file.data();
+		const char *end = position + file.size();
+		std::vector<T > values;
+		values.reserve(chromosome_size);
+
+		while(position < end) {
+			const char *line_end = std::find(position, end, '\n');
+
+			if(position < line_end && *position != '#' && *position != '\r') {
+				values.clear();
+				const char *value = position;
+				while(value < line_end) {
+					double parsed;
+					value = parse(value, line_end, parsed);
+					// The range is checked before the conversion, a value that T can not hold is undefined.
+					if(!value || parsed < min_value || parsed > max_value ||
+						(std::is_integral<T >::value && parsed != std::floor(parsed))) {
+						return false;
+					}
+					values.push_back(static_cast<T >(parsed));
+				}
+
+				if(values.size() != chromosome_size) {
+					return false;
+				}
+				population.push_back(Chromosome<T >(values));
+			}
+			position = line_end + 1;
+		}
+		return true;
+	}
+
+	/**
+	 * Parse a decimal number and the separator after it, the mapped file is not
+	 * null terminated so strtod can not be used.
+	 * @param position The start of the number.
+	 * @param end The end of the line.
+	 * @param value The output number.
+	 * @return The start of the next number or NULL if the number is not valid.
+	 */
+	static const char *parse(const char *position, const char *end, double &value) {
+
+		while(position < end && *position == ' ') {
+			position++;
+		}
+
+		bool negative = position < end && *position == '-';
+		if(position < end && (*position == '-' || *position == '+')) {
+			position++;
+		}
+
+		const char *digits = position;
+		value = 0;
+		while(position < end && *position >= '0' && *position <= '9') {
+			value = value * 10 + (*position++ - '0');
+		}
+		if(position < end && *position == '.') {
+			double scale = 0.1;
+			for(position++; position < end && *position >= '0' && *position <= '9'; position++) {
+				value+= (*position - '0') * scale;
+				scale*= 0.1;
+			}
+		}
+		if(position == digits) {
+			return NULL;
+		}
+		if(negative) {
+			value = -value;
+		}
+
+		while(position < end && (*position == ' ' || *position == '\r')) {
+			position++;
+		}
+		if(position < end) {
+			if(*position != ',') {
+				return NULL;
+			}
+			position++;
+		}
+		return position;
+	}
+};
+
+template <class T>
+constexpr const char *PopulationFile<T >::MAGIC;
+
+#endif /* POPULATION_FILE_HPP_ */
@@ -0,0 +1,219 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PROCESS_POOL_HPP_
+#define PROCESS_POOL_HPP_
+
+#include <vector>
+#include <cstddef>
+#include <sys/types.h>	// pid_t
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/atomic.hpp>
+
+/**
+ * A pool of forked worker processes used to run fitness functions that are
+ * not thread safe or may crash. Each worker process owns a slot of a shared
+ * memory ring that holds a batch of inputs and the outputs of the batch. The
+ * parent writes a batch into a free slot and signals the worker through an
+ * eventfd, the worker signals back through a second eventfd once the outputs
+ * are written.
+ *
+ * The workers are not forked by the threads of the parent. A fork server is
+ * forked once by the thread creating the pool and every worker (including the
+ * restarted ones) is forked by the single threaded server. The pool has to be
+ * created while no other thread of the process can hold a lock, the Manager
+ * creates it while its own threads are parked and the service mode does not
+ * allow worker processes since other jobs run at the same time. The workers
+ * then never inherit a lock held by another thread and die with the server,
+ * which dies with the thread that created the pool. The server reaps the workers and signals the death of a worker through
+ * the same eventfd the worker signals a finished batch through.
+ *
+ * A worker that dies while evaluating a batch is restarted and the batch is
+ * given to it again. A batch that kills its worker MAX_RETRIES times in a row
+ * is split in half and each half is tried once, so the inputs that do not crash
+ * are still evaluated. Only a single input that kills its worker MAX_RETRIES
+ * times in a row is given up on and its outputs are set to NaN.
+ */
+class ProcessPool {
+
+public:
+	/**
+	 * Evaluate a single input, run inside the worker process.
+	 * @param input The bytes of the input.
+	 * @param output The outputs of the input.
+	 */
+	typedef boost::function<void (const char *input, double *output)> Evaluator;
+
+	// The number of times a batch is restarted before it is given up on.
+	static const unsigned int MAX_RETRIES = 3;
+
+private:
+
+	static const unsigned int NO_SLOT = ~0u;
+
+	struct Slot {
+		// The worker process, only known to the fork server.
+		pid_t pid;
+		int request_fd;
+		int done_fd;
+
+		// The location of the slot within the shared memory.
+		char *memory;
+	};
+
+	// A part of the inputs given to a worker.
+	struct Batch {
+		unsigned int slot;
+		unsigned int start;
+		unsigned int count;
+		unsigned int retries;
+	};
+
+	// The header at the start of each slot.
+	struct SlotHeader {
+		unsigned int count;
+		unsigned int shutdown;
+	};
+
+	Evaluator evaluator;
+
+	unsigned int batch_size;
+	std::size_t input_size;
+	unsigned int output_size;
+
+	std::vector<Slot > slots;
+	char *memory;
+
+	pid_t server;
+	// The write end of the pipe the slots to start a worker for are sent through.
+	int spawn_fd;
+	std::size_t slot_size;
+	std::size_t memory_size;
+
+	// The slots not in use by a calling thread.
+	std::vector<unsigned int > free_slots;
+	boost::mutex mtx_;
+	boost::condition_variable available;
+
+	boost::atomic<unsigned long long> restarts;
+	boost::atomic<unsigned long long> failures;
+
+public:
+
+	/**
+	 * Create the shared memory and fork the worker processes.
+	 * @param num_processes The number of worker processes.
+	 * @param batch_size The maximum number of inputs given to a worker at once.
+	 * @param input_size The size in bytes of each input.
+	 * @param output_size The number of outputs of each input.
+	 * @param evaluator The function run by the workers for each input.
+	 */
+	ProcessPool(unsigned int num_processes, unsigned int batch_size, std::size_t input_size,
+		unsigned int output_size, Evaluator evaluator);
+
+	/**
+	 * Stop the worker processes and release the shared memory.
+	 */
+	~ProcessPool();
+
+	/**
+	 * Evaluate the inputs with the worker processes, the inputs are split into
+	 * batches that are run on as many workers as are free. Can be called by
+	 * several threads at once.
+	 * @param input The inputs, each of input_size bytes.
+	 * @param count The number of inputs.
+	 * @param output The outputs, output_size for each input. The outputs of
+	 * inputs that could not be evaluated are NaN.
+	 */
+	void evaluate(const char *input, unsigned int count, double *output);
+
+	/**
+	 * Get the number of times a worker process was restarted.
+	 */
+	unsigned long long getRestarts();
+
+	/**
+	 * Get the number of inputs given up on.
+	 */
+	unsigned long long getFailures();
+
+private:
+
+	/**
+	 * Ask the fork server to start the worker process of the slot.
+	 * @param index The index of the slot.
+	 */
+	void spawn(unsigned int index);
+
+	/**
+	 * The loop run by the fork server, forks the workers it is asked for and
+	 * reaps them, does not return.
+	 * @param request_fd The read end of the pipe the slots are sent through.
+	 */
+	void serve(int request_fd);
+
+	/**
+	 * Signal the death of the worker of the slot to the thread waiting on it,
+	 * run by the fork server.
+	 * @param index The index of the slot.
+	 */
+	void died(unsigned int index);
+
+	/**
+	 * The loop run by the worker process, does not return.
+	 * @param index The index of the slot.
+	 */
+	void work(unsigned int index);
+
+	/**
+	 * Copy a batch into the slot and signal its worker.
+	 */
+	void submit(unsigned int index, const char *input, unsigned int count);
+
+	/**
+	 * Wait for the worker of the slot to finish its batch.
+	 * @return Whether the worker finished, false if the worker died.
+	 */
+	bool wait(unsigned int index);
+
+	/**
+	 * Take a free slot.
+	 * @param block Whether to wait for a slot to become free.
+	 * @return The index of the slot or NO_SLOT if none are free and block is false.
+	 */
+	unsigned int acquire(bool block);
+
+	/**
+	 * Return a slot to the free slots.
+	 */
+	void release(unsigned int index);
+
+	ProcessPool(const ProcessPool &);
+	ProcessPool &operator=(const ProcessPool &);
+};
+
+#endif /* PROCESS_POOL_HPP_ */
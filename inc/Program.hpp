@@ -0,0 +1,282 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PROGRAM_HPP_
+#define PROGRAM_HPP_
+
+#include <vector>
+#include <random>	// mt19937
+#include <cstddef>	// size_t
+
+#include "Chromosome.hpp"
+#include "Arena.hpp"
+
+/**
+ * The operations of a genetic programming instruction. The binary operations
+ * take the two subtrees that follow them, division is protected and gives 1
+ * for a divisor close to 0.
+ */
+enum Opcode {
+	OP_ADD,
+	OP_SUB,
+	OP_MUL,
+	OP_DIV,
+	OP_VARIABLE,
+	OP_CONSTANT
+};
+
+/**
+ * A node of a program. A program is a tree stored as a flat array of its nodes
+ * in prefix order, so every subtree is a contiguous range of the array.
+ * The default instruction is the constant 0.
+ */
+struct Instruction {
+	unsigned short opcode;
+	// The index of the input of a OP_VARIABLE.
+	unsigned short variable;
+	// The value of a OP_CONSTANT.
+	float constant;
+
+	Instruction() : opcode(OP_CONSTANT), variable(0), constant(0) {
+	}
+
+	Instruction(Opcode opcode, unsigned short variable=0, float constant=0) : opcode(opcode),
+		variable(variable), constant(constant) {
+	}
+
+	inline bool operator==(const Instruction &other) const {
+		return opcode == other.opcode && variable == other.variable && constant == other.constant;
+	}
+
+	inline bool operator!=(const Instruction &other) const { return !(*this == other); }
+};
+
+std::size_t hash_value(const Instruction &instruction);
+
+// The storage of a program, the same as the storage of Chromosome<Instruction >.
+typedef std::vector<Instruction, ArenaAllocator<Instruction > > ProgramCode;
+
+/**
+ * The tree operations on programs stored in prefix order. The programs are
+ * used as Chromosome<Instruction >, the size of the chromosome given to the
+ * Manager is the maximum length of a program. The shape of the programs is
+ * kept per thread like the range of the other chromosomes, so runs of
+ * different shapes can share the process.
+ */
+class Program {
+
+	static thread_local unsigned int num_variables;
+	static thread_local unsigned int initial_depth;
+	static thread_local unsigned int mutation_depth;
+	static thread_local float min_constant;
+	static thread_local float max_constant;
+	static thread_local unsigned int max_length;
+
+public:
+
+	/**
+	 * Set the inputs and the shape of the programs for the calling thread, this
+	 * must be called before creating the Manager and be given to the Manager's
+	 * threads with Manager::setThreadSetup.
+	 * @param num_variables The number of inputs of the programs.
+	 * @param initial_depth The maximum depth of the random initial programs.
+	 * @param mutation_depth The maximum depth of the subtree inserted by a mutation.
+	 * @param min_constant The minimum value of the random constants.
+	 * @param max_constant The maximum value of the random constants, constants
+	 * are not used when this is not above min_constant.
+	 */
+	static void setup(unsigned int num_variables, unsigned int initial_depth=4,
+		unsigned int mutation_depth=2, float min_constant=-1, float max_constant=1);
+
+	/**
+	 * Set the maximum length of a program, offspring that would be longer are
+	 * replaced by a copy of their parent.
+	 * @param length The maximum number of instructions.
+	 */
+	static void setMaxLength(unsigned int length);
+
+	static unsigned int getNumVariables();
+
+	/**
+	 * Get the number of operands of an instruction.
+	 * @param instruction The instruction.
+	 */
+	static unsigned int arity(const Instruction &instruction) {
+		return instruction.opcode < OP_VARIABLE ? 2 : 0;
+	}
+
+	/**
+	 * Find the end of the subtree starting at an instruction.
+	 * @param code The program.
+	 * @param size The number of instructions of the program.
+	 * @param start The first instruction of the subtree.
+	 * @return The index after the last instruction of the subtree or 0 if the
+	 * subtree is not complete.
+	 */
+	static unsigned int subtreeEnd(const Instruction *code, unsigned int size, unsigned int start);
+
+	/**
+	 * Replace the program with a random program of at most the initial depth.
+	 * @param code The program.
+	 * @param engine The random number generator.
+	 */
+	static void random(ProgramCode &code, std::mt19937 &engine);
+
+	/**
+	 * Replace a random subtree of the program with a random subtree.
+	 * @param code The program.
+	 * @param engine The random number generator.
+	 */
+	static void mutate(ProgramCode &code, std::mt19937 &engine);
+
+	/**
+	 * Swap a random subtree of each parent to create two children. A child
+	 * longer than the maximum length is a copy of its first parent instead.
+	 * @param first The first parent.
+	 * @param second The second parent.
+	 * @param first_child The first parent with the subtree of the second.
+	 * @param second_child The second parent with the subtree of the first.
+	 * @param engine The random number generator.
+	 */
+	static void crossover(const ProgramCode &first, const ProgramCode &second,
+		ProgramCode &first_child, ProgramCode &second_child, std::mt19937 &engine);
+
+private:
+
+	/**
+	 * Append a random tree.
+	 * @param code The program the tree is appended to.
+	 * @param depth The maximum depth of the tree.
+	 * @param engine The random number generator.
+	 */
+	static void grow(ProgramCode &code, unsigned int depth, std::mt19937 &engine);
+
+	/**
+	 * Get the deepest tree that always fits in the given number of instructions.
+	 * @param length The number of instructions.
+	 * @param depth The wanted depth.
+	 */
+	static unsigned int fit(unsigned int length, unsigned int depth);
+};
+
+/**
+ * Evaluates programs over a set of fitness cases. A program is run once for
+ * every case together, each stack entry is an array with a value per case and
+ * each instruction is a single loop over the cases. Variables are read in place
+ * from the case columns. An interpreter keeps its buffers between programs and
+ * is meant to be used by one thread, e.g. as a thread_local in the fitness function.
+ */
+class Interpreter {
+
+	unsigned int num_cases;
+
+	// The inputs, a column of num_cases values per variable.
+	std::vector<float > inputs;
+
+	// A slot of num_cases values for each stack entry that is computed.
+	std::vector<float > scratch;
+	std::vector<const float *> stack;
+
+public:
+
+	/**
+	 * Create an interpreter for the fitness cases.
+	 * @param cases The value of each variable (outer) for each case (inner).
+	 */
+	Interpreter(const std::vector<std::vector<float > > &cases);
+
+	unsigned int getNumCases() {
+		return num_cases;
+	}
+
+	/**
+	 * Run a program on every fitness case.
+	 * @param code The program, only the subtree at the first instruction is run.
+	 * @param size The number of instructions.
+	 * @return The output for each case, valid until the next run. The outputs
+	 * are NaN for an incomplete program.
+	 */
+	const float *run(const Instruction *code, unsigned int size);
+
+	const float *run(Chromosome<Instruction > &program) {
+		return run(program.size() > 0 ? &program[0] : NULL, program.size());
+	}
+};
+
+/*
+ * The genetic operators of Chromosome<Instruction > work on the program trees.
+ */
+
+template<>
+inline void Chromosome<Instruction >::initialize(unsigned int chromosome_size,
+	Instruction, Instruction) {
+	std::random_device rd;
+	random_engine = std::mt19937(rd());
+	Program::setMaxLength(chromosome_size);
+}
+
+template<>
+inline void Chromosome<Instruction >::randChromosome(std::mt19937 &engine) {
+	Program::random(chromosome, engine);
+}
+
+template<>
+inline void Chromosome<Instruction >::mutate(std::mt19937 &engine) {
+	Program::mutate(chromosome, engine);
+}
+
+template<>
+inline void Chromosome<Instruction >::crossover(const Chromosome<Instruction > &other,
+	std::vector<Chromosome<Instruction > > &children, std::mt19937 &engine) const {
+	children.push_back(Chromosome<Instruction >());
+	children.push_back(Chromosome<Instruction >());
+	Program::crossover(chromosome, other.chromosome, (children.end() - 2)->chromosome,
+		(children.end() - 1)->chromosome, engine);
+}
+
+/*
+ * A program is mutated (a single subtree) when any of its instructions would be
+ * by the per element rate, and the crossover type does not apply to programs.
+ */
+template<>
+inline void Chromosome<Instruction >::mutate(double rate, std::mt19937 &engine) {
+	if(rate <= 0 || chromosome.empty()) {
+		return;
+	}
+	if(rate < 1) {
+		std::geometric_distribution<unsigned int > skip(rate);
+		if(skip(engine) >= chromosome.size()) {
+			return;
+		}
+	}
+	Program::mutate(chromosome, engine);
+}
+
+template<>
+inline void Chromosome<Instruction >::crossover(const Chromosome<Instruction > &other,
+	std::vector<Chromosome<Instruction > > &children, std::mt19937 &engine, CrossoverType) const {
+	crossover(other, children, engine);
+}
+
+#endif /* PROGRAM_HPP_ */
@@ -25,6 +25,10 @@
 #ifndef INC_RESULT_HPP_
 #define INC_RESULT_HPP_
 
+/**
+ * The fitness of a chromosome sent from a worker thread to its competitor's
+ * thread, the index is the chromosome's position in the competitor's population.
+ */
 class Result {
 
 	unsigned int index;
@@ -32,19 +36,27 @@ class Result {
 
 public:
 	
-	Result();
-
-	Result(unsigned int index, double result);
+	Result() : index(0), result(0) {
+	}
 
-	unsigned int getIndex();
+	Result(unsigned int index, double result) : index(index), result(result) {
+	}
 
-	void setIndex(unsigned int index);
+	unsigned int getIndex() const {
+		return index;
+	}
 
-	void offsetIndex(unsigned int offset);
+	void setIndex(unsigned int index) {
+		this->index = index;
+	}
 
-	double getResult();
+	double getResult() const {
+		return result;
+	}
 
-	void setResult(double result);
+	void setResult(double result) {
+		this->result = result;
+	}
 
 };
 
@@ -26,10 +26,9 @@
 #define ROULETTEWHEEL_HPP_
 
 #include <random>
-#include <map>
+#include <vector>
 
 #include "Selection.hpp"
-#include "Result.hpp"
 
 class RouletteWheel : public Selection
 {
@@ -39,7 +38,12 @@ private:
     const double EPSILON = 1.0E-15;
     double left = 0.0;
     double right = 0.0 + EPSILON;
-    std::map<std::pair<double, double>, unsigned int> selection;
+
+    // The upper bound of each chromosome's interval (a running sum of the fitness)
+    // and the chromosome the interval belongs to. The vectors keep their storage
+    // between generations.
+    std::vector<double> upper_bounds;
+    std::vector<unsigned int> selection;
 
 public:
     /**
@@ -55,18 +59,60 @@ public:
      * chromosomes which is used to generate the selection range of chromosomes
      * for the selection method.
      *
-     * @param fitness The fitness distribution for the chromosomes to be used
+     * @param fitness The fitness of each chromosome by its index, to be used
      * for the roulette wheel selection.
      */
-    virtual void init(std::vector<Result > &fitness);
+    virtual void init(const std::vector<double > &fitness);
+
+    /**
+     * Resize the selection table so it can be filled by several threads at
+     * once with set(), each thread filling its own positions.
+     *
+     * @param size The number of chromosomes.
+     */
+    void resize(unsigned int size);
+
+    /**
+     * The width of the interval of a chromosome with the given fitness.
+     *
+     * @param fitness The fitness of the chromosome.
+     * @return The width of the interval.
+     */
+    double weight(double fitness);
+
+    /**
+     * Set an interval of the selection table.
+     *
+     * @param position The position of the interval in the table.
+     * @param upper_bound The upper bound of the interval, the running sum of
+     * the weights up to and including the interval.
+     * @param chromosome The chromosome the interval belongs to.
+     */
+    void set(unsigned int position, double upper_bound, unsigned int chromosome);
+
+    /**
+     * Finish a selection table filled with set().
+     *
+     * @param total The sum of the weights of every interval.
+     */
+    void finish(double total);
 
     /**
      * The iterator method which uses roulette wheel selection to get the next
-     * chromosome to be used for the genetic algorithm.
+     * chromosome to be used for the genetic algorithm. The interval is found
+     * with a binary search over the upper bounds.
      *
      * @return The next chromosome selected.
      */
     virtual unsigned int next();
+
+    /**
+     * Roulette wheel selection using the given random number generator.
+     *
+     * @param engine The random number generator.
+     * @return The next chromosome selected.
+     */
+    virtual unsigned int next(std::mt19937 &engine);
 };
 
 #endif /* ROULETTEWHEEL_HPP_ */
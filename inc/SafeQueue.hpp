@@ -25,23 +25,44 @@
 #ifndef SAFE_QUEUE_HPP_
 #define SAFE_QUEUE_HPP_
 
-#include <queue>
+#include <vector>
 #include <boost/thread/condition_variable.hpp>
 
 template <typename T >
 class SafeQueue {
 
 private:
-	std::queue<T > values;
+	// The values are stored in a vector with the index of the front rather than
+	// a std::queue so the storage is reused once the queue has been emptied and
+	// a steady flow of values does not allocate.
+	std::vector<T > values;
+	unsigned int head;
 	boost::condition_variable m_cond;       // The condition to wait for
 	boost::mutex mtx_;
 	bool stop_waiting;
 
+	unsigned int count() {
+		return values.size() - head;
+	}
+
+	T &front() {
+		return values[head];
+	}
+
+	void pop_front() {
+		head++;
+		if(head == values.size()) {
+			values.clear();
+			head = 0;
+		}
+	}
+
 public:
 
 	SafeQueue()
 	{
 		stop_waiting = false;
+		head = 0;
 	}
 
 	~SafeQueue() {
@@ -49,7 +70,7 @@ public:
 
 	bool empty() {
 		boost::unique_lock<boost::mutex> lock(mtx_);
-		bool e = values.empty();
+		bool e = count() == 0;
 		return e;
 	}
 
@@ -69,7 +90,7 @@ public:
 
 		boost::unique_lock<boost::mutex> lock(mtx_);
 
-		while (values.size()==0 && !stop_waiting) {
+		while (count()==0 && !stop_waiting) {
 
 			if(!wait) {
 				// Queue is empty.
@@ -84,8 +105,8 @@ public:
 			return false;
 		}
 
-		result = values.front();
-		values.pop();
+		result = front();
+		pop_front();
 		return true;
 	}
 
@@ -108,7 +129,7 @@ public:
 		boost::unique_lock<boost::mutex> lock(mtx_);
 
 		// Initial design, can deadlock if no more values are added.
-		while (values.size() < amount && !stop_waiting) {
+		while (count() < amount && !stop_waiting) {
 			m_cond.wait(lock);
 		}
 
@@ -119,8 +140,8 @@ public:
 		// Pop amount of values from the queue
 		for(unsigned int i = 0; i < amount; i++) {
 
-			results.push_back(values.front());
-			values.pop();
+			results.push_back(front());
+			pop_front();
 		}
 		return true;
 	}
@@ -140,7 +161,7 @@ public:
 		boost::unique_lock<boost::mutex> lock(mtx_);
 
 		// Initial design, can deadlock if no more values are added.
-		while (values.size()==0 && !stop_waiting) {
+		while (count()==0 && !stop_waiting) {
 			m_cond.wait(lock);
 		}
 
@@ -149,10 +170,10 @@ public:
 		}
 
 		// pop off upto amount of values from the queue
-		for(unsigned int i = 0; i < amount || i < values.size(); i++) {
+		for(unsigned int i = 0; i < amount && count() != 0; i++) {
 
-			results.push_back(values.front());
-			values.pop();
+			results.push_back(front());
+			pop_front();
 		}
 		return true;
 	}
@@ -170,7 +191,7 @@ public:
 		boost::unique_lock<boost::mutex> lock(mtx_);
 
 		// Initial design, can deadlock if no more values are added.
-		while (values.size()==0 && !stop_waiting) {
+		while (count()==0 && !stop_waiting) {
 
 			if(!wait) {
 				// Queue is empty.
@@ -185,10 +206,10 @@ public:
 		}
 
 		// pop off all the available values within the queue.
-		while(values.size() != 0) {
+		while(count() != 0) {
 
-			results.push_back(values.front());
-			values.pop();
+			results.push_back(front());
+			pop_front();
 		}
 		return true;
 	}
@@ -201,7 +222,7 @@ public:
 	 */
 	void push(T &val) {
 		boost::unique_lock<boost::mutex> guard(mtx_);
-		values.push(val);
+		values.push_back(val);
 		m_cond.notify_one();
 	}
 
@@ -218,7 +239,7 @@ public:
 
 		
 		for(unsigned int i = 0; i < entries.size(); i++) {
-			values.push(entries[i]);
+			values.push_back(entries[i]);
 			m_cond.notify_one();
 		}
 	}
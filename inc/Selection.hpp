@@ -27,8 +27,8 @@
 
 #include <vector>
 #include <utility>
+#include <random>
 
-#include "Result.hpp"
 
 /**
  * Selection interface, defines the operations that all selection method
@@ -42,10 +42,10 @@ public:
      * chromosomes which is used to generate the selection range of chromosomes
      * for the selection method.
      *
-     * @param fitness The fitness distribution for the chromosomes to be used
+     * @param fitness The fitness of each chromosome by its index, to be used
      * for the selection.
      */
-    virtual void init(std::vector<Result > &fitness) = 0;
+    virtual void init(const std::vector<double > &fitness) = 0;
 
     /**
      * The iterator method which uses the selection method to get the next
@@ -55,6 +55,16 @@ public:
      */
     virtual unsigned int next() = 0;
 
+    /**
+     * Select the next chromosome using the given random number generator, this
+     * allows several threads to select concurrently once the selection is
+     * initialized.
+     *
+     * @param engine The random number generator.
+     * @return The next chromosome selected.
+     */
+    virtual unsigned int next(std::mt19937 &engine) = 0;
+
     virtual ~Selection() {}
 };
 
@@ -0,0 +1,240 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SERVER_HPP_
+#define SERVER_HPP_
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/atomic.hpp>
+
+#include "SafeQueue.hpp"
+#include "Termination.hpp"
+
+/**
+ * A client connected to the server. Lines are queued by the job threads and
+ * the connection's reader thread and written whole by the connection's writer
+ * thread, so a slow client never holds up the referee of a run sending progress.
+ * The lines still queued are written before the connection is closed.
+ */
+class Connection {
+
+	int fd;
+
+	// The lines waiting to be written and whether the writer should stop once they are.
+	std::deque<std::string > lines;
+	bool closing;
+	bool broken;
+	boost::mutex mtx_;
+	boost::condition_variable queued;
+	boost::thread writer;
+
+public:
+
+	Connection(int fd);
+
+	~Connection();
+
+	/**
+	 * Queue a line to the client, a client that has gone away is ignored.
+	 * @param line The line without the newline.
+	 */
+	void send(const std::string &line);
+
+	/**
+	 * Stop reading from and writing to the client, wakes up the reader thread.
+	 */
+	void close();
+
+	int getFd() {
+		return fd;
+	}
+
+private:
+
+	/**
+	 * Write the queued lines until the connection is destroyed, run by the writer thread.
+	 */
+	void write();
+};
+
+/**
+ * An optimization run requested by a client. The arguments are the command
+ * line options of a run, e.g. "--c 1 --t 2 --n 8 --gen 100 --pop_size 50
+ * --m_rate 0.1 --c_rate 0.5 --seed 3".
+ */
+class Job {
+
+	unsigned int id;
+	std::vector<std::string > args;
+	boost::shared_ptr<Connection > connection;
+	boost::shared_ptr<Cancellation > cancellation;
+
+	// When the last progress line was sent (seconds since the start of the run).
+	double last_progress;
+
+	// Progress is sent at most this often (seconds) so short generations do not flood the client.
+	static constexpr double PROGRESS_INTERVAL = 0.1;
+
+public:
+
+	Job(unsigned int id, const std::vector<std::string > &args, boost::shared_ptr<Connection > connection);
+
+	unsigned int getId() {
+		return id;
+	}
+
+	const std::vector<std::string > &getArgs() {
+		return args;
+	}
+
+	boost::shared_ptr<Connection > getConnection() {
+		return connection;
+	}
+
+	/**
+	 * Get the criteria that stops the run once the job is cancelled, it is
+	 * added to the Manager of the run.
+	 */
+	boost::shared_ptr<Cancellation > getCancellation() {
+		return cancellation;
+	}
+
+	/**
+	 * Send a line to the client, prefixed by its kind and the job.
+	 * @param kind The kind of the line, e.g. "progress".
+	 * @param text The rest of the line.
+	 */
+	void send(const std::string &kind, const std::string &text="");
+
+	/**
+	 * Send the statistics of a generation, given to Manager::setProgress.
+	 * @param stats The statistics.
+	 */
+	void progress(const GenerationStatistics &stats);
+};
+
+/**
+ * The service mode, runs optimization jobs sent over a local Unix socket so
+ * many short jobs do not each pay for starting a process. A fixed number of
+ * job threads is kept running for the life of the server and limits how many
+ * jobs run at once, the rest wait in a queue.
+ *
+ * The protocol is line based, the client sends
+ *   run <options>      queue a job, answered by "queued <id>"
+ *   cancel <id>        stop a queued or running job
+ *   shutdown           cancel every job and stop the server
+ * and the server answers with lines of "<kind> <id> <text>" where kind is
+ * queued, started, progress, output, done, cancelled or error. A job
+ * ends with exactly one of done, cancelled or error. The jobs of a client that
+ * disconnects are cancelled.
+ */
+class Server {
+
+public:
+	/**
+	 * Run a job on the calling job thread.
+	 * @param job The job.
+	 * @return The exit status of the run.
+	 */
+	typedef boost::function<int (Job &job)> Runner;
+
+private:
+
+	std::string path;
+	unsigned int max_jobs;
+	Runner runner;
+
+	int listen_fd;
+	boost::atomic<bool> stopping;
+
+	SafeQueue<boost::shared_ptr<Job > > queue;
+	boost::thread_group job_threads;
+	boost::thread_group reader_threads;
+
+	// The queued and running jobs by their id, and every connection.
+	std::map<unsigned int, boost::shared_ptr<Job > > jobs;
+	std::vector<boost::shared_ptr<Connection > > connections;
+	unsigned int next_id;
+	boost::mutex mtx_;
+
+public:
+
+	/**
+	 * Create the server.
+	 * @param path The path of the socket, an existing socket file is replaced.
+	 * @param max_jobs The number of jobs run at once.
+	 * @param runner The function that runs a job.
+	 */
+	Server(const std::string &path, unsigned int max_jobs, Runner runner);
+
+	~Server();
+
+	/**
+	 * Accept clients until the server is shut down.
+	 * @return 0 once shut down, -1 if the socket could not be created.
+	 */
+	int run();
+
+private:
+
+	/**
+	 * Read the requests of a client, run by a reader thread per connection.
+	 * @param connection The client.
+	 */
+	void serve(boost::shared_ptr<Connection > connection);
+
+	/**
+	 * Handle a single request line.
+	 * @param connection The client.
+	 * @param line The request.
+	 */
+	void handle(boost::shared_ptr<Connection > connection, const std::string &line);
+
+	/**
+	 * Run the queued jobs, run by each job thread.
+	 */
+	void work();
+
+	/**
+	 * Cancel the jobs of a connection, or every job if connection is NULL.
+	 * @param connection The client.
+	 */
+	void cancelJobs(Connection *connection);
+
+	/**
+	 * Stop accepting clients and wake up every thread.
+	 */
+	void stop();
+};
+
+#endif /* SERVER_HPP_ */
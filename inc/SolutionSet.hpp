@@ -0,0 +1,142 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTION_SET_HPP_
+#define SOLUTION_SET_HPP_
+
+#include <vector>
+#include <unordered_map>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
+
+#include "Chromosome.hpp"
+#include "Arena.hpp"
+
+/**
+ * A concurrent set of distinct solutions with a maximum size. The set is split
+ * into stripes (each with its own mutex) selected by the chromosome's hash so
+ * competitors adding solutions rarely contend for the same lock. Chromosomes
+ * are keyed by their hash so the genes are only hashed once per insert and only
+ * copied when the chromosome is new.
+ */
+template <class T>
+class SolutionSet {
+
+private:
+	static const unsigned int NUM_STRIPES = 16;
+
+	struct Stripe {
+		std::unordered_multimap<std::size_t, Chromosome<T > > values;
+		boost::mutex mtx_;
+	};
+
+	Stripe stripes[NUM_STRIPES];
+	boost::atomic<unsigned int> count;
+	unsigned int capacity;
+
+public:
+
+	/**
+	 * Create a solution set.
+	 * @param capacity The maximum number of solutions stored.
+	 */
+	SolutionSet(unsigned int capacity=1000) : count(0), capacity(capacity) {
+	}
+
+	~SolutionSet() {
+	}
+
+	/**
+	 * Set the maximum number of solutions stored, this should be set before
+	 * solutions are added.
+	 * @param capacity The maximum number of solutions stored.
+	 */
+	void setCapacity(unsigned int capacity) {
+		this->capacity = capacity;
+	}
+
+	unsigned int size() {
+		return count;
+	}
+
+	/**
+	 * Add the solution if it is not already within the set and there is room.
+	 * @param chromosome The solution.
+	 * @return Whether the solution was added.
+	 */
+	bool insert(Chromosome<T > &chromosome) {
+
+		if(count >= capacity) {
+			return false;
+		}
+
+		std::size_t hash = chromosome.hash();
+		Stripe &stripe = stripes[hash % NUM_STRIPES];
+		boost::unique_lock<boost::mutex> lock(stripe.mtx_);
+
+		auto range = stripe.values.equal_range(hash);
+		for(auto it = range.first; it != range.second; ++it) {
+			if(it->second == chromosome) {
+				return false;
+			}
+		}
+
+		// Reserve the slot before inserting so concurrent inserts cannot exceed the capacity.
+		if(count.fetch_add(1) >= capacity) {
+			count.fetch_sub(1);
+			return false;
+		}
+
+		// The solutions outlive the generation so they are kept on the heap.
+		ArenaScope heap(NULL);
+		stripe.values.insert(std::make_pair(hash, chromosome));
+		return true;
+	}
+
+	/**
+	 * Retrieve a copy of all the solutions.
+	 * @param result The output solutions.
+	 */
+	void getAll(std::vector<Chromosome<T > > &result) {
+		result.clear();
+		for(unsigned int i = 0; i < NUM_STRIPES; i++) {
+			boost::unique_lock<boost::mutex> lock(stripes[i].mtx_);
+			for(auto it = stripes[i].values.begin(); it != stripes[i].values.end(); ++it) {
+				result.push_back(it->second);
+			}
+		}
+	}
+
+	void clear() {
+		for(unsigned int i = 0; i < NUM_STRIPES; i++) {
+			boost::unique_lock<boost::mutex> lock(stripes[i].mtx_);
+			stripes[i].values.clear();
+		}
+		count = 0;
+	}
+};
+
+
+#endif /* SOLUTION_SET_HPP_ */
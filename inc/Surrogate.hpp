@@ -0,0 +1,219 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SURROGATE_HPP_
+#define SURROGATE_HPP_
+
+#include <vector>
+#include <algorithm>	// min
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "Chromosome.hpp"
+
+/**
+ * A k nearest neighbour model of the fitness function, trained on the
+ * chromosomes that have been evaluated. The distance between chromosomes is
+ * the number of elements that differ, the prediction is the mean fitness of
+ * the nearest chromosomes weighted by the inverse of their distance.
+ *
+ * The evaluated chromosomes are kept in a ring so the model follows the
+ * population, the oldest chromosome is replaced once the archive is full.
+ *
+ * The archive is scanned linearly. The chromosomes of a population are about
+ * equally far apart, so the bounds of a metric index (pivots, vantage points)
+ * rarely exclude any of them and hashing would only give approximate neighbours.
+ */
+template <class T>
+class Surrogate {
+
+public:
+	// The most neighbours used for a prediction.
+	static const unsigned int MAX_NEIGHBOURS = 32;
+
+private:
+	unsigned int capacity;
+	unsigned int neighbours;
+	unsigned int chromosome_size;
+
+	// The elements of each archived chromosome, one row of chromosome_size per chromosome.
+	std::vector<T > genes;
+	std::vector<double > fitness;
+	unsigned int count;
+	unsigned int next;
+	boost::shared_mutex mtx_;
+
+	// How well the predictions matched the fitness of the chromosomes that were evaluated.
+	double error_sum;
+	unsigned long long compared;
+	unsigned long long predictions;
+	boost::mutex stats_mtx_;
+
+public:
+
+	/**
+	 * Create an empty surrogate.
+	 * @param capacity The number of evaluated chromosomes kept.
+	 * @param neighbours The number of nearest chromosomes used for each prediction.
+	 */
+	Surrogate(unsigned int capacity=2000, unsigned int neighbours=5) : chromosome_size(0) {
+		setup(capacity, neighbours);
+	}
+
+	~Surrogate() {
+	}
+
+	/**
+	 * Change the size of the archive and the number of neighbours, the archive is cleared.
+	 * @param capacity The number of evaluated chromosomes kept.
+	 * @param neighbours The number of nearest chromosomes used for each prediction.
+	 */
+	void setup(unsigned int capacity, unsigned int neighbours) {
+		boost::unique_lock<boost::shared_mutex> lock(mtx_);
+		this->capacity = std::max(capacity, 1u);
+		this->neighbours = std::max(std::min(neighbours, MAX_NEIGHBOURS), 1u);
+		genes.clear();
+		fitness.clear();
+		count = 0;
+		next = 0;
+
+		boost::unique_lock<boost::mutex> stats_lock(stats_mtx_);
+		error_sum = 0;
+		compared = 0;
+		predictions = 0;
+	}
+
+	/**
+	 * Whether enough chromosomes have been evaluated to make predictions.
+	 */
+	bool ready() {
+		boost::shared_lock<boost::shared_mutex> lock(mtx_);
+		return count >= neighbours;
+	}
+
+	/**
+	 * Add an evaluated chromosome to the archive.
+	 * @param chromosome The chromosome.
+	 * @param value The fitness of the chromosome.
+	 */
+	void add(Chromosome<T > &chromosome, double value) {
+		boost::unique_lock<boost::shared_mutex> lock(mtx_);
+
+		if(genes.empty()) {
+			chromosome_size = chromosome.size();
+			genes.resize(capacity * chromosome_size);
+			fitness.resize(capacity);
+		}
+
+		for(unsigned int i = 0; i < chromosome_size; i++) {
+			genes[next * chromosome_size + i] = chromosome[i];
+		}
+		fitness[next] = value;
+
+		next = (next + 1) % capacity;
+		count = std::min(count + 1, capacity);
+	}
+
+	/**
+	 * Predict the fitness of a chromosome.
+	 * @param chromosome The chromosome.
+	 * @return The predicted fitness.
+	 */
+	double predict(Chromosome<T > &chromosome) {
+		boost::shared_lock<boost::shared_mutex> lock(mtx_);
+
+		// The nearest chromosomes found so far, sorted by their distance.
+		unsigned int nearest_distance[MAX_NEIGHBOURS];
+		double nearest_fitness[MAX_NEIGHBOURS];
+		unsigned int found = 0;
+
+		// Both sides of the comparison are contiguous so the distance is vectorised.
+		const T *query = &chromosome[0];
+		for(unsigned int j = 0; j < count; j++) {
+			const T *row = &genes[j * chromosome_size];
+			unsigned int distance = 0;
+			for(unsigned int i = 0; i < chromosome_size; i++) {
+				distance+= row[i] != query[i];
+			}
+
+			if(distance == 0) {
+				return fitness[j];
+			}
+
+			if(found < neighbours || distance < nearest_distance[found - 1]) {
+				unsigned int position = found < neighbours ? found++ : found - 1;
+				while(position > 0 && nearest_distance[position - 1] > distance) {
+					nearest_distance[position] = nearest_distance[position - 1];
+					nearest_fitness[position] = nearest_fitness[position - 1];
+					position--;
+				}
+				nearest_distance[position] = distance;
+				nearest_fitness[position] = fitness[j];
+			}
+		}
+
+		double weighted = 0;
+		double weights = 0;
+		for(unsigned int i = 0; i < found; i++) {
+			weighted+= nearest_fitness[i] / nearest_distance[i];
+			weights+= 1.0 / nearest_distance[i];
+		}
+		return weights > 0 ? weighted / weights : 0;
+	}
+
+	/**
+	 * Record the outcome of the predictions made for a range of chromosomes.
+	 * @param error The sum of the absolute errors of the predictions that were checked.
+	 * @param checked The number of predictions checked against the fitness function.
+	 * @param used The number of predictions used instead of the fitness function.
+	 */
+	void record(double error, unsigned int checked, unsigned int used) {
+		boost::unique_lock<boost::mutex> lock(stats_mtx_);
+		error_sum+= error;
+		compared+= checked;
+		predictions+= used;
+	}
+
+	/**
+	 * Get the number of predictions used instead of evaluating the fitness function.
+	 */
+	unsigned long long getPredictions() {
+		boost::unique_lock<boost::mutex> lock(stats_mtx_);
+		return predictions;
+	}
+
+	/**
+	 * Get the mean absolute error of the predictions that were checked against the fitness function.
+	 */
+	double getError() {
+		boost::unique_lock<boost::mutex> lock(stats_mtx_);
+		return compared > 0 ? error_sum / compared : 0;
+	}
+};
+
+template<class T>
+const unsigned int Surrogate<T >::MAX_NEIGHBOURS;
+
+#endif /* SURROGATE_HPP_ */
@@ -0,0 +1,204 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TERMINATION_HPP_
+#define TERMINATION_HPP_
+
+#include <boost/atomic.hpp>
+
+/**
+ * Summary of the population after a generation has been evaluated. The values
+ * are gathered by the referee while it builds the master fitness and are passed
+ * to each termination criteria so no criteria needs to look at the population.
+ */
+struct GenerationStatistics {
+
+	// The number of generations that have been evaluated.
+	unsigned int generation;
+
+	double best_fitness;
+	double mean_fitness;
+
+	// Standard deviation of the fitness values, used as a measure of diversity.
+	double fitness_deviation;
+
+	// The size of the non-dominated front of the generation, only set in the
+	// multi-objective mode where the fitness of a chromosome is its mean objective.
+	unsigned int front_size;
+
+	// Total number of fitness function evaluations since the start of the run.
+	unsigned long long evaluations;
+
+	// Total number of fitness values predicted by the surrogate instead of evaluated,
+	// and the mean absolute error of the predictions checked against the fitness function.
+	unsigned long long surrogate_predictions;
+	double surrogate_error;
+
+	// Total number of fitness function evaluations used by the local search of the memetic mode.
+	unsigned long long local_search_evaluations;
+
+	// Total seconds the scheduled evaluation of the generations was predicted to take
+	// and took, the longest competitor of each generation once its cost model is trained.
+	double predicted_makespan;
+	double actual_makespan;
+
+	// Seconds since the start of the run.
+	double elapsed_time;
+
+	// Seconds spent initializing the population at the start of the run.
+	double startup_time;
+
+	// Calls to operator new during the generation, only counted with GA_COUNT_ALLOCATIONS.
+	unsigned long long allocations;
+
+	GenerationStatistics();
+};
+
+/**
+ * Termination criteria interface, each criteria is updated once per generation
+ * and decides whether the run should stop.
+ */
+class TerminationCriteria {
+public:
+
+	/**
+	 * Reset any state that is kept between generations. Called at the start of
+	 * each run.
+	 */
+	virtual void init() {}
+
+	/**
+	 * Update the criteria with the latest generation.
+	 *
+	 * @param stats The statistics of the generation that was just evaluated.
+	 * @return Whether the run should stop.
+	 */
+	virtual bool update(const GenerationStatistics &stats) = 0;
+
+	virtual ~TerminationCriteria() {}
+};
+
+/**
+ * Stop once the best fitness is within the tolerance of the target fitness.
+ */
+class FitnessTarget : public TerminationCriteria {
+
+	double target;
+	double tolerance;
+
+public:
+
+	FitnessTarget(double target, double tolerance=0.0);
+
+	virtual bool update(const GenerationStatistics &stats);
+};
+
+/**
+ * Stop once the best fitness has not improved by more than min_improvement
+ * for max_stall consecutive generations.
+ */
+class StallGenerations : public TerminationCriteria {
+
+	unsigned int max_stall;
+	double min_improvement;
+
+	unsigned int stalled;
+	double best_fitness;
+	bool started;
+
+public:
+
+	StallGenerations(unsigned int max_stall, double min_improvement=0.0);
+
+	virtual void init();
+
+	virtual bool update(const GenerationStatistics &stats);
+};
+
+/**
+ * Stop once the population has collapsed, that is the standard deviation of the
+ * fitness values drops to or below the threshold.
+ */
+class DiversityCollapse : public TerminationCriteria {
+
+	double min_deviation;
+
+public:
+
+	DiversityCollapse(double min_deviation);
+
+	virtual bool update(const GenerationStatistics &stats);
+};
+
+/**
+ * Stop once the run has used up its wall clock budget (in seconds).
+ */
+class TimeLimit : public TerminationCriteria {
+
+	double max_time;
+
+public:
+
+	TimeLimit(double max_time);
+
+	virtual bool update(const GenerationStatistics &stats);
+};
+
+/**
+ * Stop once the run has used up its budget of fitness function evaluations.
+ */
+class EvaluationLimit : public TerminationCriteria {
+
+	unsigned long long max_evaluations;
+
+public:
+
+	EvaluationLimit(unsigned long long max_evaluations);
+
+	virtual bool update(const GenerationStatistics &stats);
+};
+
+/**
+ * Stop once the run has been cancelled from another thread, used by the
+ * service mode to cancel a running job.
+ */
+class Cancellation : public TerminationCriteria {
+
+	boost::atomic<bool> cancelled;
+
+public:
+
+	Cancellation();
+
+	/**
+	 * Stop the run at the end of the current generation.
+	 */
+	void cancel();
+
+	bool isCancelled();
+
+	virtual bool update(const GenerationStatistics &stats);
+};
+
+#endif /* TERMINATION_HPP_ */
@@ -0,0 +1,80 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TOPOLOGY_HPP_
+#define TOPOLOGY_HPP_
+
+#include <vector>
+#include <string>
+
+/**
+ * The NUMA nodes of the machine and the CPUs of each node, read from sysfs.
+ * Machines without NUMA information are treated as a single node with every CPU.
+ */
+class Topology {
+
+	std::vector<std::vector<unsigned int > > node_cpus;
+
+public:
+
+	/**
+	 * Read the topology of the machine.
+	 */
+	Topology();
+
+	/**
+	 * Get the number of NUMA nodes with CPUs.
+	 */
+	unsigned int nodes();
+
+	/**
+	 * Get the CPUs of a node.
+	 * @param node The node.
+	 */
+	const std::vector<unsigned int > &cpus(unsigned int node);
+
+	/**
+	 * Restrict the calling thread to the CPUs of a node. Memory first touched by
+	 * the thread afterwards is allocated on the node by the default policy.
+	 * @param node The node.
+	 * @return Whether the affinity was set.
+	 */
+	bool pin(unsigned int node);
+
+	/**
+	 * Let the calling thread run on the CPUs of every node again, e.g. once a
+	 * thread pinned with pin() is parked until the next run.
+	 * @return Whether the affinity was set.
+	 */
+	bool unpin();
+
+	/**
+	 * Parse a sysfs CPU list, e.g. "0-3,8-11".
+	 * @param list The list.
+	 * @param cpus The output CPUs.
+	 */
+	static void parseList(const std::string &list, std::vector<unsigned int > &cpus);
+};
+
+#endif /* TOPOLOGY_HPP_ */
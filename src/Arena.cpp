@@ -0,0 +1,132 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include <boost/atomic.hpp>
+
+#include "Arena.hpp"
+
+static thread_local GenerationArena *current_arena = NULL;
+
+GenerationArena::GenerationArena(std::size_t chunk_size) {
+	this->chunk_size = chunk_size;
+	this->current_chunk = 0;
+	this->offset = 0;
+	this->chunk_allocations = 0;
+}
+
+GenerationArena::~GenerationArena() {
+	for(unsigned int i = 0; i < chunks.size(); i++) {
+		std::free(chunks[i].memory);
+	}
+}
+
+void *GenerationArena::allocate(std::size_t bytes, std::size_t alignment) {
+
+	while(current_chunk < chunks.size()) {
+		std::size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+		if(aligned + bytes <= chunks[current_chunk].size) {
+			offset = aligned + bytes;
+			return chunks[current_chunk].memory + aligned;
+		}
+
+		// The rest of the chunk is wasted until the next reset.
+		current_chunk++;
+		offset = 0;
+	}
+
+	// Out of chunks, the heap memory is aligned for any type.
+	Chunk chunk;
+	chunk.size = bytes > chunk_size ? bytes : chunk_size;
+	chunk.memory = static_cast<char *>(std::malloc(chunk.size));
+	if(!chunk.memory) {
+		throw std::bad_alloc();
+	}
+	chunk_allocations++;
+
+	chunks.push_back(chunk);
+	current_chunk = chunks.size() - 1;
+	offset = bytes;
+	return chunk.memory;
+}
+
+void GenerationArena::reset() {
+	current_chunk = 0;
+	offset = 0;
+}
+
+unsigned long long GenerationArena::getChunkAllocations() {
+	return chunk_allocations;
+}
+
+GenerationArena *GenerationArena::current() {
+	return current_arena;
+}
+
+void GenerationArena::setCurrent(GenerationArena *arena) {
+	current_arena = arena;
+}
+
+#ifdef GA_COUNT_ALLOCATIONS
+
+static boost::atomic<unsigned long long> allocation_count(0);
+
+void *operator new(std::size_t size) {
+	allocation_count.fetch_add(1, boost::memory_order_relaxed);
+	void *p = std::malloc(size ? size : 1);
+	if(!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+bool AllocationCounter::enabled() {
+	return true;
+}
+
+unsigned long long AllocationCounter::count() {
+	return allocation_count.load(boost::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::enabled() {
+	return false;
+}
+
+unsigned long long AllocationCounter::count() {
+	return 0;
+}
+
+#endif
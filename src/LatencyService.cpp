@@ -0,0 +1,99 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>	// max
+
+#include <boost/bind.hpp>
+
+#include "LatencyService.hpp"
+
+LatencyService::LatencyService(unsigned int num_threads, double latency) :
+	latency(std::chrono::duration_cast<std::chrono::steady_clock::duration >(std::chrono::duration<double >(latency))),
+	sequence(0), max_pending(0), stopping(false) {
+	for(unsigned int i = 0; i < std::max(num_threads, 1u); i++) {
+		threads.create_thread(boost::bind(&LatencyService::work, this));
+	}
+}
+
+LatencyService::~LatencyService() {
+	{
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		stopping = true;
+	}
+	changed.notify_all();
+	threads.join_all();
+}
+
+std::future<double > LatencyService::submit(boost::function<double ()> evaluate) {
+	Request request;
+	request.due = std::chrono::steady_clock::now() + latency;
+	request.evaluate = evaluate;
+	request.promise.reset(new std::promise<double >());
+	std::future<double > answer = request.promise->get_future();
+
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	request.sequence = sequence++;
+	requests.push(request);
+	max_pending = std::max(max_pending, static_cast<unsigned int >(requests.size()));
+	lock.unlock();
+
+	changed.notify_one();
+	return answer;
+}
+
+unsigned int LatencyService::getMaxPending() {
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	return max_pending;
+}
+
+void LatencyService::work() {
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	while(!stopping) {
+		if(requests.empty()) {
+			changed.wait(lock);
+			continue;
+		}
+
+		// Sleep until the soonest request is due, a sooner one may arrive meanwhile.
+		std::chrono::steady_clock::duration wait = requests.top().due - std::chrono::steady_clock::now();
+		if(wait > std::chrono::steady_clock::duration::zero()) {
+			changed.timed_wait(lock, boost::posix_time::microseconds(
+				std::chrono::duration_cast<std::chrono::microseconds >(wait).count() + 1));
+			continue;
+		}
+
+		Request request = requests.top();
+		requests.pop();
+		lock.unlock();
+
+		try {
+			request.promise->set_value(request.evaluate());
+		}
+		catch(...) {
+			request.promise->set_exception(std::current_exception());
+		}
+
+		lock.lock();
+	}
+}
@@ -0,0 +1,65 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "MappedFile.hpp"
+
+MappedFile::MappedFile(const std::string &path) : memory(NULL), length(0), open(false) {
+
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		return;
+	}
+
+	struct stat info;
+	if(fstat(fd, &info) == 0) {
+		open = true;
+		length = info.st_size;
+	}
+
+	// A zero length mapping is not allowed.
+	if(open && length > 0) {
+		void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping == MAP_FAILED) {
+			open = false;
+			length = 0;
+		} else {
+			// The file is read once from start to end.
+			madvise(mapping, length, MADV_SEQUENTIAL);
+			memory = static_cast<const char *>(mapping);
+		}
+	}
+	// The mapping stays valid once the file is closed.
+	::close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if(memory) {
+		munmap(const_cast<char *>(memory), length);
+	}
+}
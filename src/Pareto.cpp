@@ -0,0 +1,151 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "Pareto.hpp"
+
+
+bool Pareto::dominates(const std::vector<double > &a, const std::vector<double > &b) {
+	bool better = false;
+	for(unsigned int i = 0; i < a.size(); i++) {
+		if(a[i] < b[i]) {
+			return false;
+		}
+		if(a[i] > b[i]) {
+			better = true;
+		}
+	}
+	return better;
+}
+
+void Pareto::sort(const std::vector<std::vector<double > > &objectives,
+	std::vector<std::vector<unsigned int > > &fronts, std::vector<unsigned int > &rank) {
+
+	std::vector<unsigned int > indexes(objectives.size());
+	for(unsigned int i = 0; i < indexes.size(); i++) {
+		indexes[i] = i;
+	}
+	order(objectives, indexes.begin(), indexes.end());
+	assign(objectives, indexes, fronts, rank);
+}
+
+void Pareto::order(const std::vector<std::vector<double > > &objectives,
+	std::vector<unsigned int >::iterator first, std::vector<unsigned int >::iterator last) {
+
+	// Lexicographically best first, so nothing can be dominated by a later vector.
+	std::sort(first, last, [&objectives](unsigned int a, unsigned int b) {
+		return objectives[a] > objectives[b];
+	});
+}
+
+void Pareto::merge(const std::vector<std::vector<double > > &objectives,
+	std::vector<unsigned int >::iterator first, std::vector<unsigned int >::iterator middle,
+	std::vector<unsigned int >::iterator last) {
+
+	std::inplace_merge(first, middle, last, [&objectives](unsigned int a, unsigned int b) {
+		return objectives[a] > objectives[b];
+	});
+}
+
+void Pareto::assign(const std::vector<std::vector<double > > &objectives, const std::vector<unsigned int > &order,
+	std::vector<std::vector<unsigned int > > &fronts, std::vector<unsigned int > &rank) {
+
+	fronts.clear();
+	rank.assign(objectives.size(), 0);
+
+	for(unsigned int i = 0; i < order.size(); i++) {
+		const std::vector<double > &current = objectives[order[i]];
+		bool bi_objective = current.size() == 2;
+
+		// Binary search for the first front that does not dominate the current vector.
+		unsigned int low = 0;
+		unsigned int high = fronts.size();
+		while(low < high) {
+			unsigned int mid = (low + high) / 2;
+			const std::vector<unsigned int > &front = fronts[mid];
+
+			bool dominated = false;
+			if(bi_objective) {
+				// The last member has the best second objective of the front.
+				dominated = dominates(objectives[front.back()], current);
+			} else {
+				// Later members are the most likely to dominate.
+				for(unsigned int j = front.size(); j > 0 && !dominated; j--) {
+					dominated = dominates(objectives[front[j-1]], current);
+				}
+			}
+
+			if(dominated) {
+				low = mid + 1;
+			} else {
+				high = mid;
+			}
+		}
+
+		if(low == fronts.size()) {
+			fronts.push_back(std::vector<unsigned int >());
+		}
+		fronts[low].push_back(order[i]);
+		rank[order[i]] = low;
+	}
+}
+
+void Pareto::crowding(const std::vector<std::vector<double > > &objectives,
+	const std::vector<unsigned int > &front, std::vector<double > &distance) {
+
+	if(distance.size() < objectives.size()) {
+		distance.resize(objectives.size());
+	}
+	for(unsigned int i = 0; i < front.size(); i++) {
+		distance[front[i]] = 0;
+	}
+	if(front.empty()) {
+		return;
+	}
+
+	std::vector<unsigned int > sorted(front);
+	unsigned int num_objectives = objectives[front[0]].size();
+
+	for(unsigned int m = 0; m < num_objectives; m++) {
+		std::sort(sorted.begin(), sorted.end(), [&objectives, m](unsigned int a, unsigned int b) {
+			return objectives[a][m] < objectives[b][m];
+		});
+
+		double min = objectives[sorted.front()][m];
+		double max = objectives[sorted.back()][m];
+
+		distance[sorted.front()] = std::numeric_limits<double >::infinity();
+		distance[sorted.back()] = std::numeric_limits<double >::infinity();
+
+		if(max == min) {
+			continue;
+		}
+
+		for(unsigned int i = 1; i + 1 < sorted.size(); i++) {
+			distance[sorted[i]]+= (objectives[sorted[i+1]][m] - objectives[sorted[i-1]][m]) / (max - min);
+		}
+	}
+}
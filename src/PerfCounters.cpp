@@ -0,0 +1,134 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>	// memset
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "PerfCounters.hpp"
+
+PhaseCounts::PhaseCounts() {
+	for(unsigned int i = 0; i < NUM_COUNTER_EVENTS; i++) {
+		counts[i] = 0;
+	}
+}
+
+PhaseCounts &PhaseCounts::operator+=(const PhaseCounts &other) {
+	for(unsigned int i = 0; i < NUM_COUNTER_EVENTS; i++) {
+		counts[i]+= other.counts[i];
+	}
+	return *this;
+}
+
+PerfCounters::PerfCounters() {
+	for(unsigned int i = 0; i < NUM_COUNTER_EVENTS; i++) {
+		fds[i] = -1;
+		start_counts[i] = 0;
+	}
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+	for(unsigned int i = 0; i < NUM_COUNTER_EVENTS; i++) {
+		if(fds[i] >= 0) {
+			close(fds[i]);
+		}
+	}
+#endif
+}
+
+unsigned int PerfCounters::open() {
+	unsigned int events = 0;
+#ifdef __linux__
+	const unsigned long long configs[NUM_COUNTER_EVENTS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+
+	for(unsigned int i = 0; i < NUM_COUNTER_EVENTS; i++) {
+		if(fds[i] >= 0) {
+			events|= 1u << i;
+			continue;
+		}
+
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		// The calling thread on any CPU.
+		fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if(fds[i] >= 0) {
+			events|= 1u << i;
+		}
+	}
+#endif
+	return events;
+}
+
+void PerfCounters::start() {
+	read(start_counts);
+}
+
+void PerfCounters::stop(PhaseCounts &counts) {
+	unsigned long long now[NUM_COUNTER_EVENTS];
+	read(now);
+	for(unsigned int i = 0; i < NUM_COUNTER_EVENTS; i++) {
+		counts.counts[i]+= now[i] - start_counts[i];
+	}
+}
+
+void PerfCounters::read(unsigned long long *counts) {
+	for(unsigned int i = 0; i < NUM_COUNTER_EVENTS; i++) {
+		counts[i] = 0;
+#ifdef __linux__
+		if(fds[i] >= 0 && ::read(fds[i], &counts[i], sizeof(counts[i])) != sizeof(counts[i])) {
+			counts[i] = 0;
+		}
+#endif
+	}
+}
+
+const char *PerfCounters::name(CounterEvent event) {
+	static const char *names[NUM_COUNTER_EVENTS] = {
+		"cycles", "instructions", "LLC misses", "branch misses"
+	};
+	return names[event];
+}
+
+const char *PerfCounters::name(GenerationPhase phase) {
+	static const char *names[NUM_GENERATION_PHASES] = {
+		"evaluation", "selection", "breeding", "referee"
+	};
+	return names[phase];
+}
@@ -0,0 +1,395 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>		// memcpy
+#include <cerrno>
+#include <limits>		// quiet_NaN
+#include <stdexcept>	// runtime_error
+#include <deque>
+#include <algorithm>		// min, fill
+
+#include <unistd.h>			// fork, pipe2, read, write, close, _exit
+#include <fcntl.h>			// O_CLOEXEC
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#include "ProcessPool.hpp"
+#include "Arena.hpp"
+
+// Added to the done eventfd of a slot by the fork server when its worker dies, the lower
+// bits count the batches the worker finished.
+static const uint64_t WORKER_DIED = static_cast<uint64_t>(1) << 32;
+
+// Keep the slots and the outputs within them aligned for doubles.
+static std::size_t align(std::size_t size) {
+	return (size + 63) & ~static_cast<std::size_t>(63);
+}
+
+ProcessPool::ProcessPool(unsigned int num_processes, unsigned int batch_size, std::size_t input_size,
+	unsigned int output_size, Evaluator evaluator) : evaluator(evaluator), batch_size(batch_size),
+	input_size(input_size), output_size(output_size), restarts(0), failures(0) {
+
+	slot_size = align(sizeof(SlotHeader)) + align(batch_size * input_size) +
+		align(batch_size * output_size * sizeof(double));
+	memory_size = slot_size * num_processes;
+
+	// The ring is shared with the workers, it is created before they are forked.
+	void *shared = mmap(NULL, memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(shared == MAP_FAILED) {
+		throw std::runtime_error("Unable to map the shared memory of the process pool");
+	}
+	memory = static_cast<char *>(shared);
+
+	slots.resize(num_processes);
+	for(unsigned int i = 0; i < num_processes; i++) {
+		slots[i].pid = -1;
+		slots[i].memory = memory + i * slot_size;
+		slots[i].request_fd = eventfd(0, EFD_CLOEXEC);
+		slots[i].done_fd = eventfd(0, EFD_CLOEXEC);
+		if(slots[i].request_fd < 0 || slots[i].done_fd < 0) {
+			throw std::runtime_error("Unable to create the eventfd of the process pool");
+		}
+
+		SlotHeader *header = reinterpret_cast<SlotHeader *>(slots[i].memory);
+		header->count = 0;
+		header->shutdown = 0;
+	}
+
+	int spawn_pipe[2];
+	if(pipe2(spawn_pipe, O_CLOEXEC) < 0) {
+		throw std::runtime_error("Unable to create the pipe of the process pool");
+	}
+
+	// Only safe while no other thread can hold a lock the server would inherit, see the class comment.
+	server = fork();
+	if(server < 0) {
+		throw std::runtime_error("Unable to fork the server of the process pool");
+	}
+	if(server == 0) {
+		close(spawn_pipe[1]);
+		serve(spawn_pipe[0]);
+	}
+	close(spawn_pipe[0]);
+	spawn_fd = spawn_pipe[1];
+
+	for(unsigned int i = 0; i < num_processes; i++) {
+		spawn(i);
+		free_slots.push_back(i);
+	}
+}
+
+ProcessPool::~ProcessPool() {
+	for(unsigned int i = 0; i < slots.size(); i++) {
+		SlotHeader *header = reinterpret_cast<SlotHeader *>(slots[i].memory);
+		header->shutdown = 1;
+		uint64_t value = 1;
+		if(write(slots[i].request_fd, &value, sizeof(value)) != sizeof(value)) {
+			// The workers die with the server.
+			kill(server, SIGKILL);
+		}
+	}
+
+	// The server waits for the workers to exit once the pipe is closed.
+	close(spawn_fd);
+	waitpid(server, NULL, 0);
+
+	for(unsigned int i = 0; i < slots.size(); i++) {
+		close(slots[i].request_fd);
+		close(slots[i].done_fd);
+	}
+	munmap(memory, memory_size);
+}
+
+void ProcessPool::evaluate(const char *input, unsigned int count, double *output) {
+
+	// The batches that have been submitted and are waited on in order.
+	std::deque<Batch, ArenaAllocator<Batch > > running;
+	// The halves of the split batches that have not been submitted yet.
+	std::vector<Batch, ArenaAllocator<Batch > > halves;
+
+	unsigned int next = 0;
+	while(next < count || !halves.empty() || !running.empty()) {
+
+		// Hand out batches while there are free workers, but always keep at least one running.
+		if(next < count || !halves.empty()) {
+			unsigned int slot = acquire(running.empty());
+			if(slot != NO_SLOT) {
+				Batch batch;
+				if(!halves.empty()) {
+					batch = halves.back();
+					halves.pop_back();
+				}
+				else {
+					batch.start = next;
+					batch.count = std::min(batch_size, count - next);
+					batch.retries = 0;
+					next+= batch.count;
+				}
+				batch.slot = slot;
+				submit(slot, input + batch.start * input_size, batch.count);
+				running.push_back(batch);
+				continue;
+			}
+		}
+
+		Batch batch = running.front();
+		running.pop_front();
+
+		if(wait(batch.slot)) {
+			const double *outputs = reinterpret_cast<const double *>(slots[batch.slot].memory +
+				slot_size - align(batch_size * output_size * sizeof(double)));
+			std::memcpy(output + batch.start * output_size, outputs, batch.count * output_size * sizeof(double));
+			release(batch.slot);
+		}
+		else if(++batch.retries < MAX_RETRIES) {
+			// The worker has been restarted, the input might have been overwritten by the crash.
+			submit(batch.slot, input + batch.start * input_size, batch.count);
+			running.push_back(batch);
+		}
+		else if(batch.count > 1) {
+			// Narrow down the inputs that crash, a half is tried once before it is split
+			// again and only a single input is given all of the retries.
+			Batch half = batch;
+			batch.count/= 2;
+			half.start+= batch.count;
+			half.count-= batch.count;
+			batch.retries = batch.count > 1 ? MAX_RETRIES - 1 : 0;
+			half.retries = half.count > 1 ? MAX_RETRIES - 1 : 0;
+
+			submit(batch.slot, input + batch.start * input_size, batch.count);
+			running.push_back(batch);
+			halves.push_back(half);
+		}
+		else {
+			std::fill(output + batch.start * output_size, output + (batch.start + batch.count) * output_size,
+				std::numeric_limits<double >::quiet_NaN());
+			failures+= batch.count;
+			release(batch.slot);
+		}
+	}
+}
+
+unsigned long long ProcessPool::getRestarts() {
+	return restarts;
+}
+
+unsigned long long ProcessPool::getFailures() {
+	return failures;
+}
+
+void ProcessPool::spawn(unsigned int index) {
+
+	// A request the previous worker did not read is picked up by the new worker. The index
+	// is smaller than PIPE_BUF so the writes of several threads are not interleaved.
+	ssize_t written;
+	while((written = write(spawn_fd, &index, sizeof(index))) < 0 && errno == EINTR) {
+	}
+	if(written != sizeof(index)) {
+		throw std::runtime_error("Unable to reach the server of the process pool");
+	}
+}
+
+void ProcessPool::serve(int request_fd) {
+
+	// Do not outlive the thread that created the pool.
+	prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+	// The deaths of the workers are read with the requests instead of in a handler.
+	sigset_t children;
+	sigemptyset(&children);
+	sigaddset(&children, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &children, NULL);
+	int signal_fd = signalfd(-1, &children, SFD_CLOEXEC);
+	if(signal_fd < 0) {
+		_exit(1);
+	}
+
+	struct pollfd fds[2];
+	fds[0].fd = request_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = signal_fd;
+	fds[1].events = POLLIN;
+
+	while(true) {
+		fds[0].revents = 0;
+		fds[1].revents = 0;
+		if(poll(fds, 2, -1) < 0) {
+			continue;
+		}
+
+		if(fds[1].revents & POLLIN) {
+			struct signalfd_siginfo info;
+			if(read(signal_fd, &info, sizeof(info)) < 0 && errno != EINTR) {
+				_exit(1);
+			}
+
+			// Several deaths may be merged into one signal.
+			pid_t pid;
+			while((pid = waitpid(-1, NULL, WNOHANG)) > 0) {
+				for(unsigned int i = 0; i < slots.size(); i++) {
+					if(slots[i].pid == pid) {
+						slots[i].pid = -1;
+						died(i);
+						break;
+					}
+				}
+			}
+		}
+
+		if(fds[0].revents & (POLLIN | POLLHUP)) {
+			unsigned int index;
+			ssize_t bytes = read(request_fd, &index, sizeof(index));
+			if(bytes == 0) {
+				// The pool has been destroyed.
+				break;
+			}
+			if(bytes != sizeof(index) || index >= slots.size()) {
+				continue;
+			}
+
+			pid_t pid = fork();
+			if(pid == 0) {
+				sigprocmask(SIG_UNBLOCK, &children, NULL);
+				close(signal_fd);
+				close(request_fd);
+				work(index);
+			}
+			if(pid > 0) {
+				slots[index].pid = pid;
+			}
+			else {
+				// The batch is retried the same as if the worker had crashed.
+				died(index);
+			}
+		}
+	}
+
+	// The workers exit once they read the shutdown.
+	while(waitpid(-1, NULL, 0) > 0 || errno == EINTR) {
+	}
+	_exit(0);
+}
+
+void ProcessPool::died(unsigned int index) {
+	uint64_t value = WORKER_DIED;
+	while(write(slots[index].done_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+	}
+}
+
+void ProcessPool::work(unsigned int index) {
+
+	// Do not outlive the fork server.
+	prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+	Slot &slot = slots[index];
+	SlotHeader *header = reinterpret_cast<SlotHeader *>(slot.memory);
+	const char *input = slot.memory + align(sizeof(SlotHeader));
+	double *output = reinterpret_cast<double *>(slot.memory + slot_size -
+		align(batch_size * output_size * sizeof(double)));
+
+	while(true) {
+		uint64_t value;
+		if(read(slot.request_fd, &value, sizeof(value)) != sizeof(value)) {
+			if(errno == EINTR) {
+				continue;
+			}
+			_exit(1);
+		}
+
+		if(header->shutdown) {
+			_exit(0);
+		}
+
+		try {
+			for(unsigned int i = 0; i < header->count; i++) {
+				evaluator(input + i * input_size, output + i * output_size);
+			}
+		}
+		catch(...) {
+			// Treated the same as a crash by the parent.
+			_exit(1);
+		}
+
+		value = 1;
+		if(write(slot.done_fd, &value, sizeof(value)) != sizeof(value)) {
+			_exit(1);
+		}
+	}
+}
+
+void ProcessPool::submit(unsigned int index, const char *input, unsigned int count) {
+	SlotHeader *header = reinterpret_cast<SlotHeader *>(slots[index].memory);
+	header->count = count;
+	std::memcpy(slots[index].memory + align(sizeof(SlotHeader)), input, count * input_size);
+
+	uint64_t value = 1;
+	while(write(slots[index].request_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+	}
+}
+
+bool ProcessPool::wait(unsigned int index) {
+
+	// Only the thread holding the slot waits on its worker.
+	uint64_t value;
+	while(read(slots[index].done_fd, &value, sizeof(value)) != sizeof(value)) {
+		if(errno != EINTR) {
+			throw std::runtime_error("Unable to wait on a worker of the process pool");
+		}
+	}
+
+	if(value >= WORKER_DIED) {
+		restarts++;
+		spawn(index);
+
+		// The worker may have finished the batch just before it died.
+		return (value & (WORKER_DIED - 1)) > 0;
+	}
+	return true;
+}
+
+unsigned int ProcessPool::acquire(bool block) {
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	while(free_slots.empty()) {
+		if(!block) {
+			return NO_SLOT;
+		}
+		available.wait(lock);
+	}
+
+	unsigned int index = free_slots.back();
+	free_slots.pop_back();
+	return index;
+}
+
+void ProcessPool::release(unsigned int index) {
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	free_slots.push_back(index);
+	available.notify_one();
+}
@@ -0,0 +1,255 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cmath>		// fabs
+#include <limits>		// quiet_NaN
+#include <algorithm>	// min, fill
+
+#include <boost/functional/hash.hpp>
+
+#include "Program.hpp"
+
+// Division by a value closer to 0 than this gives 1.
+#define PROTECTED_DIVISION 1e-6f
+
+thread_local unsigned int Program::num_variables = 1;
+thread_local unsigned int Program::initial_depth = 4;
+thread_local unsigned int Program::mutation_depth = 2;
+thread_local float Program::min_constant = -1;
+thread_local float Program::max_constant = 1;
+thread_local unsigned int Program::max_length = 63;
+
+std::size_t hash_value(const Instruction &instruction) {
+	std::size_t seed = 0;
+	boost::hash_combine(seed, instruction.opcode);
+	boost::hash_combine(seed, instruction.variable);
+	boost::hash_combine(seed, instruction.constant);
+	return seed;
+}
+
+void Program::setup(unsigned int num_variables, unsigned int initial_depth,
+	unsigned int mutation_depth, float min_constant, float max_constant) {
+	Program::num_variables = std::max(num_variables, 1u);
+	Program::initial_depth = initial_depth;
+	Program::mutation_depth = mutation_depth;
+	Program::min_constant = min_constant;
+	Program::max_constant = max_constant;
+}
+
+void Program::setMaxLength(unsigned int length) {
+	max_length = std::max(length, 1u);
+}
+
+unsigned int Program::getNumVariables() {
+	return num_variables;
+}
+
+unsigned int Program::subtreeEnd(const Instruction *code, unsigned int size, unsigned int start) {
+	// The number of subtrees still to be read.
+	unsigned int open = 1;
+	for(unsigned int i = start; i < size; i++) {
+		open+= arity(code[i]);
+		if(--open == 0) {
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+void Program::random(ProgramCode &code, std::mt19937 &engine) {
+	code.clear();
+	grow(code, fit(max_length, initial_depth), engine);
+}
+
+void Program::mutate(ProgramCode &code, std::mt19937 &engine) {
+	if(code.empty()) {
+		random(code, engine);
+		return;
+	}
+
+	std::uniform_int_distribution<unsigned int > point_dist(0, code.size() - 1);
+	unsigned int start = point_dist(engine);
+	unsigned int end = subtreeEnd(code.data(), code.size(), start);
+	if(end == 0) {
+		random(code, engine);
+		return;
+	}
+
+	// The replacement can use the space of the removed subtree.
+	unsigned int rest = code.size() - (end - start);
+	unsigned int space = rest < max_length ? max_length - rest : 1;
+
+	ProgramCode subtree;
+	grow(subtree, fit(space, mutation_depth), engine);
+	code.erase(code.begin() + start, code.begin() + end);
+	code.insert(code.begin() + start, subtree.begin(), subtree.end());
+}
+
+void Program::crossover(const ProgramCode &first, const ProgramCode &second,
+	ProgramCode &first_child, ProgramCode &second_child, std::mt19937 &engine) {
+
+	if(first.empty() || second.empty()) {
+		first_child.assign(first.begin(), first.end());
+		second_child.assign(second.begin(), second.end());
+		return;
+	}
+
+	std::uniform_int_distribution<unsigned int > first_dist(0, first.size() - 1);
+	std::uniform_int_distribution<unsigned int > second_dist(0, second.size() - 1);
+	unsigned int first_start = first_dist(engine);
+	unsigned int second_start = second_dist(engine);
+	unsigned int first_end = subtreeEnd(first.data(), first.size(), first_start);
+	unsigned int second_end = subtreeEnd(second.data(), second.size(), second_start);
+	if(first_end == 0 || second_end == 0) {
+		first_child.assign(first.begin(), first.end());
+		second_child.assign(second.begin(), second.end());
+		return;
+	}
+
+	// Each child is the prefix of its parent, the subtree of the other parent and the suffix.
+	unsigned int first_size = first.size() - (first_end - first_start) + (second_end - second_start);
+	if(first_size <= max_length) {
+		first_child.reserve(first_size);
+		first_child.assign(first.begin(), first.begin() + first_start);
+		first_child.insert(first_child.end(), second.begin() + second_start, second.begin() + second_end);
+		first_child.insert(first_child.end(), first.begin() + first_end, first.end());
+	} else {
+		first_child.assign(first.begin(), first.end());
+	}
+
+	unsigned int second_size = second.size() - (second_end - second_start) + (first_end - first_start);
+	if(second_size <= max_length) {
+		second_child.reserve(second_size);
+		second_child.assign(second.begin(), second.begin() + second_start);
+		second_child.insert(second_child.end(), first.begin() + first_start, first.begin() + first_end);
+		second_child.insert(second_child.end(), second.begin() + second_end, second.end());
+	} else {
+		second_child.assign(second.begin(), second.end());
+	}
+}
+
+void Program::grow(ProgramCode &code, unsigned int depth, std::mt19937 &engine) {
+
+	bool constants = max_constant > min_constant;
+	unsigned int terminals = constants ? 2 : 1;
+
+	// Pick uniformly from the operations and the kinds of terminals, only terminals at the maximum depth.
+	std::uniform_int_distribution<unsigned int > kind_dist(0, depth > 0 ? OP_VARIABLE + terminals - 1 : terminals - 1);
+	unsigned int kind = kind_dist(engine);
+	if(depth == 0) {
+		kind+= OP_VARIABLE;
+	}
+
+	if(kind < OP_VARIABLE) {
+		code.push_back(Instruction(static_cast<Opcode >(kind)));
+		grow(code, depth - 1, engine);
+		grow(code, depth - 1, engine);
+	} else if(kind == OP_VARIABLE) {
+		std::uniform_int_distribution<unsigned int > variable_dist(0, num_variables - 1);
+		code.push_back(Instruction(OP_VARIABLE, variable_dist(engine)));
+	} else {
+		std::uniform_real_distribution<float > constant_dist(min_constant, max_constant);
+		code.push_back(Instruction(OP_CONSTANT, 0, constant_dist(engine)));
+	}
+}
+
+unsigned int Program::fit(unsigned int length, unsigned int depth) {
+	// A full binary tree of depth d has 2^(d+1) - 1 nodes.
+	unsigned int fitting = 0;
+	while(fitting < depth && (2u << (fitting + 1)) - 1 <= length) {
+		fitting++;
+	}
+	return fitting;
+}
+
+Interpreter::Interpreter(const std::vector<std::vector<float > > &cases) {
+	num_cases = cases.empty() ? 0 : cases[0].size();
+	inputs.reserve(cases.size() * num_cases);
+	for(unsigned int i = 0; i < cases.size(); i++) {
+		inputs.insert(inputs.end(), cases[i].begin(), cases[i].begin() + num_cases);
+	}
+}
+
+const float *Interpreter::run(const Instruction *code, unsigned int size) {
+
+	unsigned int length = code ? Program::subtreeEnd(code, size, 0) : 0;
+	if(scratch.size() < (std::max(length, 1u)) * num_cases) {
+		scratch.resize(std::max(length, 1u) * num_cases);
+	}
+
+	if(length == 0) {
+		std::fill(scratch.begin(), scratch.begin() + num_cases, std::numeric_limits<float >::quiet_NaN());
+		return scratch.data();
+	}
+
+	// Walking the prefix order backwards pushes the operands before their operation.
+	stack.clear();
+	for(unsigned int i = length; i-- > 0;) {
+		const Instruction &instruction = code[i];
+		float *out = &scratch[stack.size() * num_cases];
+
+		if(instruction.opcode == OP_VARIABLE) {
+			stack.push_back(&inputs[instruction.variable * num_cases]);
+			continue;
+		}
+		if(instruction.opcode == OP_CONSTANT) {
+			std::fill(out, out + num_cases, instruction.constant);
+			stack.push_back(out);
+			continue;
+		}
+
+		// The left operand was pushed last, the result replaces the right operand.
+		const float *a = stack.back();
+		stack.pop_back();
+		const float *b = stack.back();
+		out = &scratch[(stack.size() - 1) * num_cases];
+
+		switch(instruction.opcode) {
+		case OP_ADD:
+			for(unsigned int c = 0; c < num_cases; c++) {
+				out[c] = a[c] + b[c];
+			}
+			break;
+		case OP_SUB:
+			for(unsigned int c = 0; c < num_cases; c++) {
+				out[c] = a[c] - b[c];
+			}
+			break;
+		case OP_MUL:
+			for(unsigned int c = 0; c < num_cases; c++) {
+				out[c] = a[c] * b[c];
+			}
+			break;
+		default:
+			for(unsigned int c = 0; c < num_cases; c++) {
+				out[c] = std::fabs(b[c]) > PROTECTED_DIVISION ? a[c] / b[c] : 1.0f;
+			}
+			break;
+		}
+		stack.back() = out;
+	}
+
+	// A program that is a single variable returns its column.
+	return stack.back();
+}
@@ -22,6 +22,8 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+
 #include "RouletteWheel.hpp"
 
 
@@ -35,54 +37,74 @@ RouletteWheel::~RouletteWheel() {
 
 }
 
-void RouletteWheel::init(std::vector<Result > &fitness)
+void RouletteWheel::init(const std::vector<double > &fitness)
 {
-	// Ensure the selection map is empty.
+	// Ensure the selection table is empty.
+	upper_bounds.clear();
 	selection.clear();
 
 	// Right was not clearing and therefore the range continued to expand (always picked 0 for next).
-	this->right = 0;
-
-	// Is it really necessary for the left to even have a variable (it is always 0).
-	double lower = this->left;
-	double upper = this->right;
+	this->right = this->left;
 
-	// Calculate the right bound
-	for (auto it = fitness.begin(); it != fitness.end(); ++it)
+	// Each chromosome gets the interval [previous upper bound, upper bound), the
+	// EPSILON gives chromosomes with a fitness of 0 a (tiny) chance.
+	for (unsigned int i = 0; i < fitness.size(); ++i)
 	{
-		this->right += it->getResult() + this->EPSILON;
+		this->right += fitness[i] + this->EPSILON;
+		this->upper_bounds.push_back(this->right);
+		this->selection.push_back(i);
 	}
 
 	// Initialize the uniform distribution random generator
 	this->distribution = std::uniform_real_distribution<double>(this->left, this->right);
+}
 
-	// Add each chromosome and interval to roulette wheel selection
+void RouletteWheel::resize(unsigned int size)
+{
+	this->upper_bounds.resize(size);
+	this->selection.resize(size);
+}
 
-	// TODO consider using a sorted map, when iterated through will go from largest to smallest
-	// fitness (since the roulette wheel is most likely going to hit the large values and thus
-	// save time in the look through)
-	for (auto it = fitness.begin(); it != fitness.end(); ++it)
-	{
-		upper = lower + it->getResult();
-		this->selection.insert({std::make_pair(lower, upper), it->getIndex()});
-		lower = upper + this->EPSILON;
-	}
+double RouletteWheel::weight(double fitness)
+{
+	return fitness + this->EPSILON;
+}
+
+void RouletteWheel::set(unsigned int position, double upper_bound, unsigned int chromosome)
+{
+	this->upper_bounds[position] = this->left + upper_bound;
+	this->selection[position] = chromosome;
+}
+
+void RouletteWheel::finish(double total)
+{
+	this->right = this->left + total;
+	this->distribution = std::uniform_real_distribution<double>(this->left, this->right);
 }
 
 unsigned int RouletteWheel::next()
 {
-	double rand_num = this->distribution(this->engine);
+	return next(this->engine);
+}
+
+unsigned int RouletteWheel::next(std::mt19937 &engine)
+{
+	// Only the range of the distribution is shared.
+	std::uniform_real_distribution<double> dist(this->distribution.param());
+	double rand_num = dist(engine);
+
+	// Find the first interval whose upper bound is past the random number
+	auto it = std::upper_bound(this->upper_bounds.begin(), this->upper_bounds.end(), rand_num);
 
-	// Find the chromosome where the random number is in the interval
-	for (auto it = this->selection.begin(); it != this->selection.end(); ++it)
+	// Floating point rounding can leave the random number on the right bound.
+	if (it == this->upper_bounds.end())
 	{
-		if (rand_num >= it->first.first && rand_num < it->first.second)
+		if (this->selection.empty())
 		{
-			return it->second;
+			return 0;
 		}
+		--it;
 	}
 
-	// TODO fatal error due to floating point arithmetic if no match found!
-	//unsigned int bad_return = 0;
-	return 0;
+	return this->selection[it - this->upper_bounds.begin()];
 }
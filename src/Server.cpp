@@ -0,0 +1,341 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sstream>
+#include <cstring>	// memset, strncpy
+#include <cerrno>
+#include <algorithm>	// max
+#include <exception>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <boost/bind.hpp>
+
+#include "Server.hpp"
+
+// The number of clients waiting to be accepted.
+#define LISTEN_BACKLOG 16
+
+constexpr double Job::PROGRESS_INTERVAL;
+
+Connection::Connection(int fd) : fd(fd), closing(false), broken(false) {
+	writer = boost::thread(boost::bind(&Connection::write, this));
+}
+
+Connection::~Connection() {
+	{
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		closing = true;
+		queued.notify_one();
+	}
+	writer.join();
+	::close(fd);
+}
+
+void Connection::send(const std::string &line) {
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	if(broken) {
+		return;
+	}
+	lines.push_back(line + "\n");
+	queued.notify_one();
+}
+
+void Connection::write() {
+
+	std::string data;
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	while(true) {
+		while(lines.empty() && !closing) {
+			queued.wait(lock);
+		}
+		if(lines.empty()) {
+			return;
+		}
+
+		// The lines queued so far are written in one go without holding the lock.
+		data.clear();
+		for(unsigned int i = 0; i < lines.size(); i++) {
+			data+= lines[i];
+		}
+		lines.clear();
+		lock.unlock();
+
+		std::size_t written = 0;
+		while(written < data.size()) {
+			ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+			if(n < 0 && errno == EINTR) {
+				continue;
+			}
+			if(n <= 0) {
+				break;
+			}
+			written+= n;
+		}
+
+		lock.lock();
+		if(written < data.size()) {
+			// The client has gone away, the lines queued later are dropped.
+			broken = true;
+			lines.clear();
+		}
+	}
+}
+
+void Connection::close() {
+	::shutdown(fd, SHUT_RDWR);
+}
+
+Job::Job(unsigned int id, const std::vector<std::string > &args, boost::shared_ptr<Connection > connection) :
+	id(id), args(args), connection(connection), cancellation(new Cancellation()), last_progress(0) {
+}
+
+void Job::send(const std::string &kind, const std::string &text) {
+	std::ostringstream line;
+	line << kind << " " << id;
+	if(!text.empty()) {
+		line << " " << text;
+	}
+	connection->send(line.str());
+}
+
+void Job::progress(const GenerationStatistics &stats) {
+	if(stats.generation > 1 && stats.elapsed_time - last_progress < PROGRESS_INTERVAL) {
+		return;
+	}
+	last_progress = stats.elapsed_time;
+
+	std::ostringstream text;
+	text << "generation=" << stats.generation << " best=" << stats.best_fitness
+		<< " mean=" << stats.mean_fitness << " evaluations=" << stats.evaluations
+		<< " time=" << stats.elapsed_time;
+	send("progress", text.str());
+}
+
+Server::Server(const std::string &path, unsigned int max_jobs, Runner runner) : path(path),
+	max_jobs(std::max(max_jobs, 1u)), runner(runner), listen_fd(-1), stopping(false), next_id(1) {
+}
+
+Server::~Server() {
+	if(listen_fd >= 0) {
+		::close(listen_fd);
+	}
+}
+
+int Server::run() {
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(address.sun_path)) {
+		return -1;
+	}
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(listen_fd < 0) {
+		return -1;
+	}
+	unlink(path.c_str());
+	if(bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+		listen(listen_fd, LISTEN_BACKLOG) < 0) {
+		return -1;
+	}
+
+	// The job threads are started once and run every job for the life of the server.
+	for(unsigned int i = 0; i < max_jobs; i++) {
+		job_threads.create_thread(boost::bind(&Server::work, this));
+	}
+
+	while(!stopping) {
+		int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+		if(fd < 0) {
+			if(errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			break;
+		}
+
+		boost::shared_ptr<Connection > connection(new Connection(fd));
+		{
+			boost::unique_lock<boost::mutex> lock(mtx_);
+			connections.push_back(connection);
+		}
+		reader_threads.create_thread(boost::bind(&Server::serve, this, connection));
+	}
+
+	// Shut down, the running jobs stop at the end of their generation.
+	stopping = true;
+	cancelJobs(NULL);
+	queue.finish();
+	job_threads.join_all();
+
+	{
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		// The jobs left never left the queue.
+		for(std::map<unsigned int, boost::shared_ptr<Job > >::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+			it->second->send("cancelled");
+		}
+		jobs.clear();
+		for(unsigned int i = 0; i < connections.size(); i++) {
+			connections[i]->close();
+		}
+	}
+	reader_threads.join_all();
+
+	unlink(path.c_str());
+	return 0;
+}
+
+void Server::serve(boost::shared_ptr<Connection > connection) {
+
+	std::string buffer;
+	char data[4096];
+	while(true) {
+		ssize_t n = recv(connection->getFd(), data, sizeof(data), 0);
+		if(n < 0 && errno == EINTR) {
+			continue;
+		}
+		if(n <= 0) {
+			break;
+		}
+		buffer.append(data, n);
+
+		std::size_t end;
+		while((end = buffer.find('\n')) != std::string::npos) {
+			std::string line = buffer.substr(0, end);
+			buffer.erase(0, end + 1);
+			if(!line.empty() && line[line.size() - 1] == '\r') {
+				line.erase(line.size() - 1);
+			}
+			handle(connection, line);
+		}
+	}
+
+	// Nobody is left to read the results of the client's jobs.
+	cancelJobs(connection.get());
+
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	for(unsigned int i = 0; i < connections.size(); i++) {
+		if(connections[i] == connection) {
+			connections.erase(connections.begin() + i);
+			break;
+		}
+	}
+}
+
+void Server::handle(boost::shared_ptr<Connection > connection, const std::string &line) {
+
+	std::istringstream words(line);
+	std::string command;
+	if(!(words >> command)) {
+		return;
+	}
+
+	if(command == "run") {
+		std::vector<std::string > args;
+		std::string arg;
+		while(words >> arg) {
+			args.push_back(arg);
+		}
+
+		boost::shared_ptr<Job > job;
+		{
+			boost::unique_lock<boost::mutex> lock(mtx_);
+			if(stopping) {
+				connection->send("error 0 shutting down");
+				return;
+			}
+			job.reset(new Job(next_id++, args, connection));
+			jobs[job->getId()] = job;
+		}
+		job->send("queued");
+		queue.push(job);
+	} else if(command == "cancel") {
+		unsigned int id = 0;
+		words >> id;
+
+		boost::unique_lock<boost::mutex> lock(mtx_);
+		std::map<unsigned int, boost::shared_ptr<Job > >::iterator it = jobs.find(id);
+		if(it == jobs.end()) {
+			std::ostringstream error;
+			error << "error " << id << " unknown job";
+			connection->send(error.str());
+			return;
+		}
+		it->second->getCancellation()->cancel();
+	} else if(command == "shutdown") {
+		stop();
+	} else {
+		connection->send("error 0 unknown command " + command);
+	}
+}
+
+void Server::work() {
+
+	boost::shared_ptr<Job > job;
+	while(queue.pop(job)) {
+
+		if(job->getCancellation()->isCancelled()) {
+			job->send("cancelled");
+		} else {
+			job->send("started");
+			try {
+				int status = runner(*job);
+				if(job->getCancellation()->isCancelled()) {
+					job->send("cancelled");
+				} else {
+					std::ostringstream text;
+					text << status;
+					job->send("done", text.str());
+				}
+			} catch(std::exception &e) {
+				job->send("error", e.what());
+			}
+		}
+
+		{
+			boost::unique_lock<boost::mutex> lock(mtx_);
+			jobs.erase(job->getId());
+		}
+		job.reset();
+	}
+}
+
+void Server::cancelJobs(Connection *connection) {
+	boost::unique_lock<boost::mutex> lock(mtx_);
+	for(std::map<unsigned int, boost::shared_ptr<Job > >::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+		if(connection == NULL || it->second->getConnection().get() == connection) {
+			it->second->getCancellation()->cancel();
+		}
+	}
+}
+
+void Server::stop() {
+	stopping = true;
+	// Wakes up the accept in run().
+	::shutdown(listen_fd, SHUT_RDWR);
+}
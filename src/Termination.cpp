@@ -0,0 +1,117 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "Termination.hpp"
+
+
+GenerationStatistics::GenerationStatistics() {
+	this->generation = 0;
+	this->best_fitness = 0;
+	this->mean_fitness = 0;
+	this->fitness_deviation = 0;
+	this->front_size = 0;
+	this->evaluations = 0;
+	this->surrogate_predictions = 0;
+	this->surrogate_error = 0;
+	this->local_search_evaluations = 0;
+	this->predicted_makespan = 0;
+	this->actual_makespan = 0;
+	this->elapsed_time = 0;
+	this->startup_time = 0;
+	this->allocations = 0;
+}
+
+FitnessTarget::FitnessTarget(double target, double tolerance) {
+	this->target = target;
+	this->tolerance = tolerance;
+}
+
+bool FitnessTarget::update(const GenerationStatistics &stats) {
+	return stats.best_fitness >= this->target - this->tolerance;
+}
+
+StallGenerations::StallGenerations(unsigned int max_stall, double min_improvement) {
+	this->max_stall = max_stall;
+	this->min_improvement = min_improvement;
+	init();
+}
+
+void StallGenerations::init() {
+	this->stalled = 0;
+	this->best_fitness = 0;
+	this->started = false;
+}
+
+bool StallGenerations::update(const GenerationStatistics &stats) {
+
+	// The first generation is the baseline to improve on.
+	if(!this->started || stats.best_fitness > this->best_fitness + this->min_improvement) {
+		this->started = true;
+		this->best_fitness = stats.best_fitness;
+		this->stalled = 0;
+		return false;
+	}
+
+	this->stalled++;
+	return this->stalled >= this->max_stall;
+}
+
+DiversityCollapse::DiversityCollapse(double min_deviation) {
+	this->min_deviation = min_deviation;
+}
+
+bool DiversityCollapse::update(const GenerationStatistics &stats) {
+	return stats.fitness_deviation <= this->min_deviation;
+}
+
+TimeLimit::TimeLimit(double max_time) {
+	this->max_time = max_time;
+}
+
+bool TimeLimit::update(const GenerationStatistics &stats) {
+	return stats.elapsed_time >= this->max_time;
+}
+
+EvaluationLimit::EvaluationLimit(unsigned long long max_evaluations) {
+	this->max_evaluations = max_evaluations;
+}
+
+bool EvaluationLimit::update(const GenerationStatistics &stats) {
+	return stats.evaluations >= this->max_evaluations;
+}
+
+Cancellation::Cancellation() : cancelled(false) {
+}
+
+void Cancellation::cancel() {
+	cancelled = true;
+}
+
+bool Cancellation::isCancelled() {
+	return cancelled;
+}
+
+bool Cancellation::update(const GenerationStatistics &) {
+	return cancelled;
+}
@@ -0,0 +1,121 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>	// strtoul
+#include <algorithm>	// max
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <boost/thread/thread.hpp>
+
+#include "Topology.hpp"
+
+Topology::Topology() {
+
+	// The node numbers may have gaps, stop after a run of missing nodes.
+	for(unsigned int node = 0, missing = 0; missing < 64; node++) {
+		std::ostringstream path;
+		path << "/sys/devices/system/node/node" << node << "/cpulist";
+		std::ifstream file(path.str().c_str());
+		std::string list;
+		if(!file || !std::getline(file, list)) {
+			missing++;
+			continue;
+		}
+		missing = 0;
+
+		std::vector<unsigned int > cpus;
+		parseList(list, cpus);
+		// Memory only nodes can not run threads.
+		if(!cpus.empty()) {
+			node_cpus.push_back(cpus);
+		}
+	}
+
+	if(node_cpus.empty()) {
+		std::vector<unsigned int > cpus;
+		unsigned int count = std::max(boost::thread::hardware_concurrency(), 1u);
+		for(unsigned int i = 0; i < count; i++) {
+			cpus.push_back(i);
+		}
+		node_cpus.push_back(cpus);
+	}
+}
+
+unsigned int Topology::nodes() {
+	return node_cpus.size();
+}
+
+const std::vector<unsigned int > &Topology::cpus(unsigned int node) {
+	return node_cpus[node % node_cpus.size()];
+}
+
+bool Topology::pin(unsigned int node) {
+	const std::vector<unsigned int > &node_set = cpus(node);
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(unsigned int i = 0; i < node_set.size(); i++) {
+		if(node_set[i] < CPU_SETSIZE) {
+			CPU_SET(node_set[i], &set);
+		}
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool Topology::unpin() {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(unsigned int node = 0; node < nodes(); node++) {
+		const std::vector<unsigned int > &node_set = cpus(node);
+		for(unsigned int i = 0; i < node_set.size(); i++) {
+			if(node_set[i] < CPU_SETSIZE) {
+				CPU_SET(node_set[i], &set);
+			}
+		}
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void Topology::parseList(const std::string &list, std::vector<unsigned int > &cpus) {
+	std::istringstream ranges(list);
+	std::string range;
+	while(std::getline(ranges, range, ',')) {
+		if(range.empty()) {
+			continue;
+		}
+		char *end;
+		unsigned long first = std::strtoul(range.c_str(), &end, 10);
+		unsigned long last = first;
+		if(*end == '-') {
+			last = std::strtoul(end + 1, &end, 10);
+		}
+		for(unsigned long cpu = first; cpu <= last; cpu++) {
+			cpus.push_back(cpu);
+		}
+	}
+}
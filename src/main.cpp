@@ -24,9 +24,13 @@
 
 #include <cstdio>
 #include <cassert>
+#include <cstdlib>		// abs
 #include <iostream>     // std::cout
 #include <algorithm>    // std::swap_ranges
 #include <string>
+#include <future>		// future, async
+#include <sstream>
+#include <limits>		// numeric_limits
 
 #include <boost/thread/thread.hpp>
 #include <boost/atomic.hpp>
@@ -34,52 +38,280 @@
 
 #include "Chromosome.hpp"
 #include "Manager.hpp"
+#include "ManagerCache.hpp"
+#include "Termination.hpp"
+#include "Arena.hpp"
+#include "Program.hpp"
+#include "Server.hpp"
+#include "PerfCounters.hpp"
+#include "PopulationFile.hpp"
+#include "LatencyService.hpp"
 
-double calculate(Chromosome<unsigned int> chromosome);
+template <class T> double calculate(Chromosome<T> chromosome);
+template <class T> std::vector<double > calculateObjectives(Chromosome<T> chromosome);
+template <class T> std::future<double > calculateAsync(Chromosome<T> chromosome);
+double calculateProgram(Chromosome<Instruction> chromosome);
+double programCost(const Chromosome<Instruction> &chromosome);
+int runJob(Job &job);
 
+/**
+ * The idle Managers of the service mode with the genes of the type.
+ */
+template <class T>
+ManagerCache<T > &managerCache() {
+	static ManagerCache<T > cache;
+	return cache;
+}
+
+/**
+ * The settings of a run read from the options, the same for every problem.
+ */
+struct RunSettings {
+	std::vector<unsigned int > pop_size;
+	unsigned int chromosome_size;
+	unsigned int max_gen;
+	std::vector<double > mutation_rate;
+	std::vector<double > crossover_rate;
+	unsigned int num_competitors;
+	unsigned int num_threads;
+	std::vector<boost::shared_ptr<TerminationCriteria > > criteria;
+	unsigned int elitism;
+	unsigned int hall_of_fame_size;
+	unsigned int max_solutions;
+	AdaptationMode adaptation;
+	MutationMode mutation_mode;
+	CrossoverType crossover_type;
+	bool multi_objective;
+	bool report;
+	bool seeded;
+	unsigned int seed;
+	unsigned int processes;
+	unsigned int batch_size;
+	bool async;
+	unsigned int max_in_flight;
+	double surrogate_fraction;
+	unsigned int neighbours;
+	bool numa;
+	unsigned int chunk_size;
+	double seed_fraction;
+	std::string save_hof;
+	unsigned int memetic_count;
+	unsigned int local_search_budget;
+	WriteBack write_back;
+	bool cellular;
+	unsigned int grid_width;
+	unsigned int schedule_chunk_size;
+	unsigned int autotune;
+	bool perf_counters;
+};
+
+/**
+ * What a run needs to know of the problem, which depends on the type of the genes.
+ */
 template <class T>
-int measure_performance(std::vector<unsigned int > pop_size, unsigned int chromosome_size,
-	T min_value, T max_value, unsigned int max_gen, std::vector<double > mutation_rate,
-	std::vector<double > crossover_rate, unsigned int num_compeditors, 
-	unsigned int num_threads) {
+struct Problem {
+	T min_value;
+	T max_value;
+	// The fitness of the chromosomes, only one is set: the fitness, the objectives of
+	// the multi-objective mode or the asynchronous fitness.
+	double (*fitness)(Chromosome<T >);
+	std::vector<double > (*objectives)(Chromosome<T >);
+	std::future<double > (*async_fitness)(Chromosome<T >);
+	// The chromosomes the initial populations are seeded with, may be empty.
+	std::vector<Chromosome<T > > seeds;
+	// The local search of the memetic mode, hill climbing when empty.
+	typename Manager<T >::LocalSearch local_search;
+	// The relative cost of evaluating a chromosome for the scheduling, may be empty.
+	boost::function<double (const Chromosome<T > &)> cost_hint;
+	// Sets up the state of the problem on each thread of the Manager, may be empty.
+	boost::function<void ()> thread_setup;
 
-	Manager<unsigned int > manager(pop_size, chromosome_size, max_gen,
-				max_value, min_value, mutation_rate, crossover_rate,
-				num_compeditors, num_threads);
+	Problem() : min_value(), max_value(), fitness(0), objectives(0), async_fitness(0) {
+	}
+};
 
+template <class T>
+int measure_performance(const RunSettings &settings, const Problem<T > &problem,
+	std::ostream &out, std::ostream &report_out, Job *job) {
+
+	// The autotuning tries every thread count up to the cores on the Manager's own threads.
+	unsigned int num_threads = settings.num_threads;
+	if(settings.autotune > 0 && !settings.cellular) {
+		unsigned int smallest = *std::min_element(settings.pop_size.begin(), settings.pop_size.end());
+		num_threads = std::min(std::max(1u, boost::thread::hardware_concurrency()), smallest);
+	}
+
+	// A job of the service mode reuses the threads of a finished job of the same shape.
+	typename ManagerCache<T >::Shape shape = {settings.pop_size, settings.chromosome_size, problem.max_value, problem.min_value,
+		settings.num_competitors, num_threads};
+	boost::shared_ptr<Manager<T > > managed;
+	if(job) {
+		managed = managerCache<T >().take(shape, settings.max_gen, settings.mutation_rate, settings.crossover_rate);
+	} else {
+		managed.reset(new Manager<T >(settings.pop_size, settings.chromosome_size, settings.max_gen,
+				problem.max_value, problem.min_value, settings.mutation_rate, settings.crossover_rate,
+				settings.num_competitors, num_threads));
+	}
+	Manager<T > &manager = *managed;
+
+	if(job) {
+		manager.setProgress(boost::bind(&Job::progress, job, _1));
+		manager.addTerminationCriteria(job->getCancellation());
+	}
+	for(unsigned int i = 0; i < settings.criteria.size(); i++) {
+		manager.addTerminationCriteria(settings.criteria[i]);
+	}
+	manager.setElitism(settings.elitism);
+	manager.setHallOfFameSize(settings.hall_of_fame_size);
+	manager.setMaxSolutions(settings.max_solutions);
+	manager.setAdaptation(settings.adaptation);
+	manager.setMutationMode(settings.mutation_mode);
+	manager.setCrossoverType(settings.crossover_type);
+	if(settings.seeded) {
+		manager.setSeed(settings.seed);
+	}
+	manager.setProcessWorkers(settings.processes, settings.batch_size);
+	manager.setMaxInFlight(settings.max_in_flight);
+	manager.setSurrogate(settings.surrogate_fraction, settings.neighbours);
+	manager.setNumaPlacement(settings.numa);
+	manager.setPipelined(settings.chunk_size);
+	manager.setAutotune(settings.autotune);
+	manager.setSeeds(problem.seeds);
+	manager.setSeedFraction(settings.seed_fraction);
+	manager.setCellular(settings.cellular, settings.grid_width);
+	manager.setCostScheduling(settings.schedule_chunk_size, problem.cost_hint);
+	manager.setThreadSetup(problem.thread_setup);
+	if(problem.local_search) {
+		manager.setLocalSearch(problem.local_search, settings.memetic_count, settings.local_search_budget,
+			settings.write_back);
+	} else {
+		manager.setHillClimbing(settings.memetic_count, settings.local_search_budget, settings.write_back);
+	}
+	manager.setPerfCounters(settings.perf_counters);
+
+	unsigned int num_gen;
+	if(problem.objectives) {
+		num_gen = manager.run(problem.objectives);
+	} else if(problem.async_fitness) {
+		num_gen = manager.run(problem.async_fitness);
+	} else {
+		num_gen = manager.run(problem.fitness);
+	}
 
-	unsigned int num_gen = manager.run(&calculate);
+	std::vector<Chromosome<T > > solutions = manager.getSolutions();
 
-	std::vector<Chromosome<unsigned int> > solutions = manager.getSolutions();
+	// The hall of fame can seed the next run of the problem with --init_file, with
+	// multiple objectives the Pareto front is saved instead.
+	if(!settings.save_hof.empty()) {
+		std::vector<Chromosome<T > > best;
+		if(settings.multi_objective) {
+			std::vector<std::vector<double > > objectives;
+			manager.getParetoFront(best, objectives);
+		} else {
+			std::vector<double > fitness;
+			manager.getHallOfFame(best, fitness);
+		}
+		if(!PopulationFile<T >::save(settings.save_hof, best)) {
+			report_out << "could not write " << settings.save_hof << std::endl;
+		}
+	}
 
 	if(solutions.size() > 0) {
-		std::cout << "1";
+		out << "1";
 	}
 	else {
-		std::cout << "0";
+		out << "0";
 	}
 
-	std::cout << ", " << num_gen;
+	out << ", " << num_gen;
+
+	// The report goes to a separate stream (stderr) to keep the csv output intact.
+	if(settings.report) {
+		GenerationStatistics stats = manager.getStatistics();
+		report_out << std::endl;
+		report_out << "generations: " << stats.generation << std::endl;
+		report_out << "evaluations: " << stats.evaluations << std::endl;
+		report_out << "time (s): " << stats.elapsed_time << std::endl;
+		report_out << "startup time (s): " << stats.startup_time << std::endl;
+		report_out << "best fitness: " << stats.best_fitness << std::endl;
+		report_out << "mean fitness: " << stats.mean_fitness << std::endl;
+		if(settings.multi_objective) {
+			report_out << "last front size: " << stats.front_size << std::endl;
+		}
+		if(settings.numa) {
+			report_out << "numa nodes used: " << manager.getNumaNodes() << std::endl;
+		}
+		if(manager.getAutotunedThreads() > 0) {
+			report_out << "autotuned threads: " << manager.getAutotunedThreads() << std::endl;
+			report_out << "autotuned chunk size: " << manager.getAutotunedChunkSize() << std::endl;
+			report_out << "autotuned evaluations/s: " << manager.getAutotunedRate() << std::endl;
+		}
+		if(settings.surrogate_fraction > 0) {
+			report_out << "surrogate predictions (evaluations saved): " << stats.surrogate_predictions << std::endl;
+			report_out << "surrogate mean absolute error: " << stats.surrogate_error << std::endl;
+		}
+		if(settings.memetic_count > 0) {
+			report_out << "local search evaluations: " << stats.local_search_evaluations << std::endl;
+		}
+		if(settings.schedule_chunk_size > 0 && settings.chunk_size == 0 && manager.getAutotunedThreads() == 0) {
+			report_out << "predicted evaluation makespan (s): " << stats.predicted_makespan << std::endl;
+			report_out << "actual evaluation makespan (s): " << stats.actual_makespan << std::endl;
+		}
+		if(settings.processes > 0) {
+			report_out << "worker process restarts: " << manager.getProcessRestarts() << std::endl;
+			report_out << "failed evaluations: " << manager.getProcessFailures() << std::endl;
+		}
+		if(settings.perf_counters) {
+			std::vector<PhaseCounts > counts;
+			unsigned int events = manager.getPhaseCounts(counts);
+			if(events == 0) {
+				report_out << "hardware counters: unavailable" << std::endl;
+			}
+			for(unsigned int i = 0; i < counts.size() && events != 0; i++) {
+				report_out << PerfCounters::name(static_cast<GenerationPhase >(i)) << " counters:";
+				for(unsigned int j = 0; j < NUM_COUNTER_EVENTS; j++) {
+					report_out << " " << PerfCounters::name(static_cast<CounterEvent >(j)) << " ";
+					if(events & (1u << j)) {
+						report_out << counts[i].counts[j];
+					} else {
+						report_out << "n/a";
+					}
+				}
+				if((events & (1u << CYCLES)) && (events & (1u << INSTRUCTIONS)) && counts[i].counts[CYCLES] > 0) {
+					report_out << " IPC " << (double) counts[i].counts[INSTRUCTIONS] / counts[i].counts[CYCLES];
+				}
+				report_out << std::endl;
+			}
+		}
+		if(AllocationCounter::enabled()) {
+			report_out << "allocations (last generation): " << stats.allocations << std::endl;
+		}
+	}
+
+	if(job) {
+		managerCache<T >().give(shape, managed);
+	}
 	return 0;
-	/*std::cout << "Solutions: " << std::endl;
+	/*out << "Solutions: " << std::endl;
 	for (unsigned int i = 0; i < solutions.size(); i++) {
 		for (unsigned int j = 0; j < chromosome_size; j++) {
-			std::cout << solutions[i][j];
+			out << solutions[i][j];
 			if(j +1 < chromosome_size) {
-				std::cout << ",";
+				out << ",";
 			}
 		}
-		std::cout << '\n';
+		out << '\n';
 
 	}*/
 }
 
-double calculate(Chromosome<unsigned int> chromosome)
+template <class T>
+double calculate(Chromosome<T> chromosome)
 {
 	unsigned int numCollisions = 0;
 
 	//int numCollisions = 0;
-	for (int i = 0; i < chromosome.size(); ++i)
+	for (int i = 0; i < (int) chromosome.size(); ++i)
 	{
 		/* Wrap around the genes in the chromosome to check each one */
 		for (int j = (i + 1) % chromosome.size(); j != i; ++j, j %= chromosome.size())
@@ -113,6 +345,185 @@ double calculate(Chromosome<unsigned int> chromosome)
 	return result;//, result == 1);
 }
 
+/**
+ * The N-queens problem with the vertical and diagonal collisions as separate
+ * objectives, used to demonstrate the multi-objective mode.
+ */
+template <class T>
+std::vector<double > calculateObjectives(Chromosome<T> chromosome)
+{
+	unsigned int vertical = 0;
+	unsigned int diagonal = 0;
+
+	for (int i = 0; i < (int) chromosome.size(); ++i)
+	{
+		for (int j = (i + 1) % chromosome.size(); j != i; ++j, j %= chromosome.size())
+		{
+			if (chromosome[i] == chromosome[j])
+			{
+				++vertical;
+			}
+
+			int Yi = chromosome[i];
+			int Yj = chromosome[j];
+
+			if (fabs((double) (i - j) / (Yi - Yj)) == 1.0)
+			{
+				++diagonal;
+			}
+		}
+	}
+
+	std::vector<double > objectives;
+	objectives.push_back(1.0 / std::max(vertical, 1u));
+	objectives.push_back(1.0 / std::max(diagonal, 1u));
+	return objectives;
+}
+
+/**
+ * The number of queens a queen at the row of a column would be in conflict with.
+ */
+template <class T>
+unsigned int conflicts(Chromosome<T> &chromosome, unsigned int column, int row)
+{
+	unsigned int count = 0;
+	for (unsigned int j = 0; j < chromosome.size(); ++j)
+	{
+		int Yj = chromosome[j];
+		if (j != column && (Yj == row || std::abs((int) j - (int) column) == std::abs(Yj - row)))
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+/**
+ * Min-conflicts local search for the N-queens problem, used by the memetic mode.
+ * Each step moves a random queen that is in conflict to the row of its column with
+ * the fewest conflicts, a step costs about as much as a fitness evaluation.
+ */
+template <class T>
+unsigned int minConflicts(Chromosome<T> &chromosome, double &fitness, unsigned int budget, std::mt19937 &engine)
+{
+	unsigned int n = chromosome.size();
+	std::vector<unsigned int > conflicted;
+	std::vector<unsigned int > best_rows;
+
+	unsigned int steps = 0;
+	for (; steps < budget; ++steps)
+	{
+		conflicted.clear();
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			if (conflicts(chromosome, i, chromosome[i]) > 0)
+			{
+				conflicted.push_back(i);
+			}
+		}
+		if (conflicted.empty())
+		{
+			break;
+		}
+
+		std::uniform_int_distribution<unsigned int > column_dist(0, conflicted.size() - 1);
+		unsigned int column = conflicted[column_dist(engine)];
+
+		unsigned int fewest = n;
+		best_rows.clear();
+		for (unsigned int row = 0; row < n; ++row)
+		{
+			unsigned int count = conflicts(chromosome, column, row);
+			if (count < fewest)
+			{
+				fewest = count;
+				best_rows.clear();
+			}
+			if (count == fewest)
+			{
+				best_rows.push_back(row);
+			}
+		}
+
+		std::uniform_int_distribution<unsigned int > row_dist(0, best_rows.size() - 1);
+		chromosome[column] = best_rows[row_dist(engine)];
+	}
+
+	fitness = calculate(chromosome);
+	return steps + 1;
+}
+
+/**
+ * The N-queens fitness answered by a stub service with a latency of a
+ * millisecond, used to demonstrate the asynchronous fitness interface. The
+ * service answers every evaluation in flight with two threads.
+ */
+template <class T>
+std::future<double > calculateAsync(Chromosome<T> chromosome)
+{
+	static LatencyService service(2, 0.001);
+	return service.submit(boost::bind(calculate<T >, chromosome));
+}
+
+/**
+ * The fitness cases of the symbolic regression problem, the quartic
+ * x^4 + x^3 + x^2 + x sampled on [-1, 1].
+ */
+#define REGRESSION_CASES 20
+#define REGRESSION_HIT 0.01
+
+std::vector<std::vector<float > > regressionCases()
+{
+	std::vector<std::vector<float > > cases(1);
+	for (unsigned int i = 0; i < REGRESSION_CASES; ++i)
+	{
+		cases[0].push_back(-1.0f + 2.0f * i / (REGRESSION_CASES - 1));
+	}
+	return cases;
+}
+
+/**
+ * The symbolic regression of the quartic, used to demonstrate the genetic
+ * programming chromosomes. A program that is within REGRESSION_HIT of every
+ * case is a solution, otherwise the fitness falls with the total error.
+ */
+double calculateProgram(Chromosome<Instruction> chromosome)
+{
+	static const std::vector<std::vector<float > > cases = regressionCases();
+	static thread_local Interpreter interpreter(cases);
+
+	const float *outputs = interpreter.run(chromosome);
+
+	double error = 0;
+	unsigned int hits = 0;
+	for (unsigned int i = 0; i < interpreter.getNumCases(); ++i)
+	{
+		double x = cases[0][i];
+		double difference = fabs(outputs[i] - (x * x * x * x + x * x * x + x * x + x));
+		error+= difference;
+		hits+= difference < REGRESSION_HIT;
+	}
+
+	if (hits == interpreter.getNumCases())
+	{
+		return 1.0;
+	}
+	// NaN from an incomplete program has no fitness.
+	if (!(error == error))
+	{
+		return 0.0;
+	}
+	return 1.0 / (1.0 + error);
+}
+
+/**
+ * The cost hint of a program, the interpreter runs every instruction over every case.
+ */
+double programCost(const Chromosome<Instruction> &chromosome)
+{
+	return chromosome.size();
+}
+
 template <class T> 
 std::vector<T > parseVector(boost::program_options::variables_map vm, std::string key) {
 
@@ -123,47 +534,265 @@ std::vector<T > parseVector(boost::program_options::variables_map vm, std::strin
 	return val;
 }
 
+/**
+ * Run the N-queens problem with the genes stored as T, the smallest type that
+ * holds a column of the board unless --genes picks one.
+ */
+template <class T>
+int measure_queens(const boost::program_options::variables_map &vm, const RunSettings &settings,
+	std::ostream &out, std::ostream &report_out, Job *job) {
+
+	unsigned int chromo_size = settings.chromosome_size;
+	if (chromo_size - 1 > std::numeric_limits<T >::max()) {
+		out << "Invalid Input" << std::endl;
+		return -1;
+	}
+
+	// The genes are stored in T but the range is that of the board.
+	Problem<T > problem;
+	problem.max_value = chromo_size -1;
+	problem.min_value = 0;
+	if (settings.multi_objective) {
+		problem.objectives = &calculateObjectives<T >;
+	} else if (settings.async) {
+		problem.async_fitness = &calculateAsync<T >;
+	} else {
+		problem.fitness = &calculate<T >;
+	}
+
+	if (vm.count("init_file") && !PopulationFile<T >::load(vm["init_file"].as<std::string >(), chromo_size,
+		0, chromo_size - 1, problem.seeds)) {
+		out << "Invalid population file" << std::endl;
+		return -1;
+	}
+
+	std::string search = vm["local_search"].as<std::string >();
+	if (search == "conflicts") {
+		problem.local_search = &minConflicts<T >;
+	} else if (search != "hill") {
+		out << "Invalid Input" << std::endl;
+		return -1;
+	}
+
+	return measure_performance<T>(settings, problem, out, report_out, job);
+}
+
 // Command line interface
 // e.g. ../bin/GALibrary --c 1 --t 1 --n 8 --gen 1000 --pop_size 50 60 --m_rate 0.1 0.9 --c_rate 0.4 0.6
-int parse_args(int argc, char **argv) {
+// The jobs of the service mode use the same options and pass their job.
+int parse_args(const std::vector<std::string > &args, std::ostream &out, std::ostream &report_out, Job *job) {
 
 	namespace po = boost::program_options; 
 	po::options_description desc("Allowed options");
 	desc.add_options()
 		("c", po::value<unsigned int >(), "set the number of competitors")
 		("t", po::value<unsigned int >(), "set the number of worker threads for each competitor")
-		("n", po::value<unsigned int >(), "the number of queens")
+		("n", po::value<unsigned int >(), "the number of queens, or the maximum program length with --gp")
 		("gen", po::value<unsigned int >(), "the maximum number of generations")
 		("pop_size", po::value<std::vector<unsigned int > >()->multitoken(), "The population values for each competitor")
 		("m_rate", po::value<std::vector<double > >()->multitoken(), "The mutation rate for each competitor")
-		("c_rate", po::value<std::vector<double > >()->multitoken(), "The crossover rate for each competitor");
+		("c_rate", po::value<std::vector<double > >()->multitoken(), "The crossover rate for each competitor")
+		("target", po::value<double >(), "stop once the best fitness reaches the target")
+		("tolerance", po::value<double >()->default_value(0.0), "the tolerance used for the target fitness")
+		("stall", po::value<unsigned int >(), "stop after the number of generations without improvement")
+		("diversity", po::value<double >(), "stop once the fitness standard deviation drops to the value")
+		("time_limit", po::value<double >(), "stop after the number of seconds")
+		("max_evals", po::value<unsigned long long >(), "stop after the number of fitness evaluations")
+		("elitism", po::value<unsigned int >()->default_value(0), "the number of best chromosomes of each competitor kept each generation")
+		("hof", po::value<unsigned int >()->default_value(10), "the number of distinct best chromosomes kept in the hall of fame")
+		("max_solutions", po::value<unsigned int >()->default_value(1000), "the maximum number of distinct solutions kept")
+		("adapt", po::value<std::string >()->default_value("none"), "how the rates are adapted: none, success (1/5th rule) or diversity")
+		("mutation", po::value<std::string >()->default_value("chromosome"), "what the mutation rate applies to: chromosome (one element) or gene (each element)")
+		("crossover", po::value<std::string >()->default_value("one"), "the crossover type: one (point), two (point) or uniform")
+		("genes", po::value<std::string >()->default_value("auto"), "the bits used to store each gene: 8, 16, 32 or auto (the fewest that hold n)")
+		("mo", "treat the vertical and diagonal collisions as separate objectives (NSGA-II)")
+		("report", "print a summary of the run to stderr")
+		("seed", po::value<unsigned int >(), "the seed of the worker threads' random number generators")
+		("processes", po::value<unsigned int >()->default_value(0), "evaluate the fitness in the number of forked worker processes, not available to the jobs of --serve")
+		("batch", po::value<unsigned int >()->default_value(64), "the number of chromosomes given to a worker process at once")
+		("async", "evaluate the fitness asynchronously")
+		("in_flight", po::value<unsigned int >()->default_value(1024), "the maximum number of asynchronous evaluations at once")
+		("surrogate", po::value<double >()->default_value(0.0), "the fraction of the offspring evaluated after pre-screening with a surrogate, 0 disables it")
+		("neighbours", po::value<unsigned int >()->default_value(5), "the number of neighbours used by the surrogate")
+		("numa", "place the competitors on the NUMA nodes and pin their threads")
+		("pipeline", po::value<unsigned int >()->default_value(0), "the chunk size of the pipelined mode, 0 disables it")
+		("gp", "evolve programs for the symbolic regression of x^4 + x^3 + x^2 + x instead of the N-queens problem")
+		("depth", po::value<unsigned int >()->default_value(4), "the maximum depth of the initial programs with --gp")
+		("serve", po::value<std::string >(), "run jobs sent to the Unix socket at the path instead of a single run")
+		("jobs", po::value<unsigned int >()->default_value(1), "the number of jobs the service mode runs at once")
+		("init_file", po::value<std::string >(), "seed the initial populations from a population file (binary or CSV)")
+		("init_fraction", po::value<double >()->default_value(1.0), "the fraction of each initial population that is seeded")
+		("save_hof", po::value<std::string >(), "write the hall of fame (the Pareto front with --mo) to a population file at the end of the run")
+		("memetic", po::value<unsigned int >()->default_value(0), "the number of the best chromosomes of each competitor improved by local search each generation")
+		("local_search", po::value<std::string >()->default_value("conflicts"), "the local search of the memetic mode: hill (climbing) or conflicts (min-conflicts, N-queens only)")
+		("ls_budget", po::value<unsigned int >()->default_value(50), "the fitness evaluations given to each local search")
+		("baldwinian", "give the chromosomes the fitness found by the local search but keep them unchanged")
+		("cellular", "select the parents from the neighbouring cells of a toroidal grid, each thread runs its own tile of it (cellular GA)")
+		("grid_width", po::value<unsigned int >()->default_value(0), "the width of the grid of the cellular GA, 0 for a square grid")
+		("schedule", po::value<unsigned int >()->default_value(0), "the chunk size of the evaluation scheduled longest expected cost first, 0 disables it")
+		("autotune", po::value<unsigned int >()->default_value(0), "run the first generations pipelined, this many at each thread count and chunk size, and the rest with the fastest, 0 disables it")
+		("counters", "count the hardware events of each phase of the generations for the report");
 
 	po::variables_map vm;
-	po::store(po::parse_command_line(argc, argv, desc), vm);
+	po::store(po::command_line_parser(args).options(desc).run(), vm);
 	po::notify(vm);
 
-	unsigned int num_competitors = vm["c"].as<unsigned int >();
-	unsigned int num_threads = vm["t"].as<unsigned int >();
-	unsigned int chromo_size = vm["n"].as<unsigned int >();
-	unsigned int max_gen = vm["gen"].as<unsigned int >();
+	if (vm.count("serve") && !job) {
+		Server server(vm["serve"].as<std::string >(), vm["jobs"].as<unsigned int >(), &runJob);
+		return server.run();
+	}
+
+	RunSettings settings;
+	settings.num_competitors = vm["c"].as<unsigned int >();
+	settings.num_threads = vm["t"].as<unsigned int >();
+	settings.chromosome_size = vm["n"].as<unsigned int >();
+	settings.max_gen = vm["gen"].as<unsigned int >();
+
+	settings.pop_size = parseVector<unsigned int >(vm, "pop_size");
+	settings.mutation_rate = parseVector<double >(vm, "m_rate");
+	settings.crossover_rate = parseVector<double >(vm, "c_rate");
 
-	std::vector<unsigned int> pop_size = parseVector<unsigned int >(vm, "pop_size");
-	std::vector<double > m_rate = parseVector<double >(vm, "m_rate");
-	std::vector<double > c_rate = parseVector<double >(vm, "c_rate");
+	// Each competitor needs its population size and rates, a job of the service mode is rejected like the command line.
+	unsigned int num_competitors = settings.num_competitors;
+	if(num_competitors <= 0 || settings.pop_size.size() != num_competitors ||
+		settings.mutation_rate.size() != num_competitors || settings.crossover_rate.size() != num_competitors) {
+		out << "Invalid Input" << std::endl;
+		return -1;
+	}
 
-	if(num_competitors <= 0 && pop_size.size() == num_competitors && pop_size.size() == m_rate.size() && pop_size.size() == c_rate.size()) {
-		std::cout << "Invalid Input" << std::endl;
+	// The workers would be forked while the threads of the other jobs run, see ProcessPool.
+	if(job && vm["processes"].as<unsigned int >() > 0) {
+		out << "Worker processes are not available to jobs" << std::endl;
 		return -1;
 	}
 
-	unsigned int max_value = chromo_size -1;
-	unsigned int min_value = 0;
-	return measure_performance<unsigned int>(pop_size, chromo_size,
-		min_value, max_value, max_gen, m_rate, c_rate, 
-		num_competitors, num_threads);
+	if (vm.count("target")) {
+		settings.criteria.push_back(boost::shared_ptr<TerminationCriteria >(new FitnessTarget(
+			vm["target"].as<double >(), vm["tolerance"].as<double >())));
+	}
+	if (vm.count("stall")) {
+		settings.criteria.push_back(boost::shared_ptr<TerminationCriteria >(new StallGenerations(
+			vm["stall"].as<unsigned int >())));
+	}
+	if (vm.count("diversity")) {
+		settings.criteria.push_back(boost::shared_ptr<TerminationCriteria >(new DiversityCollapse(
+			vm["diversity"].as<double >())));
+	}
+	if (vm.count("time_limit")) {
+		settings.criteria.push_back(boost::shared_ptr<TerminationCriteria >(new TimeLimit(
+			vm["time_limit"].as<double >())));
+	}
+	if (vm.count("max_evals")) {
+		settings.criteria.push_back(boost::shared_ptr<TerminationCriteria >(new EvaluationLimit(
+			vm["max_evals"].as<unsigned long long >())));
+	}
+
+	settings.adaptation = NO_ADAPTATION;
+	std::string adapt = vm["adapt"].as<std::string >();
+	if (adapt == "success") {
+		settings.adaptation = SUCCESS_RULE;
+	} else if (adapt == "diversity") {
+		settings.adaptation = DIVERSITY_ADAPTATION;
+	} else if (adapt != "none") {
+		out << "Invalid Input" << std::endl;
+		return -1;
+	}
+
+	settings.mutation_mode = CHROMOSOME_MUTATION;
+	std::string mutation = vm["mutation"].as<std::string >();
+	if (mutation == "gene") {
+		settings.mutation_mode = GENE_MUTATION;
+	} else if (mutation != "chromosome") {
+		out << "Invalid Input" << std::endl;
+		return -1;
+	}
+
+	settings.crossover_type = ONE_POINT;
+	std::string crossover = vm["crossover"].as<std::string >();
+	if (crossover == "two") {
+		settings.crossover_type = TWO_POINT;
+	} else if (crossover == "uniform") {
+		settings.crossover_type = UNIFORM;
+	} else if (crossover != "one") {
+		out << "Invalid Input" << std::endl;
+		return -1;
+	}
+
+	settings.elitism = vm["elitism"].as<unsigned int >();
+	settings.hall_of_fame_size = vm["hof"].as<unsigned int >();
+	settings.max_solutions = vm["max_solutions"].as<unsigned int >();
+	settings.multi_objective = vm.count("mo") > 0;
+	settings.report = vm.count("report") > 0;
+	settings.seeded = vm.count("seed") > 0;
+	settings.seed = settings.seeded ? vm["seed"].as<unsigned int >() : 0;
+	settings.processes = vm["processes"].as<unsigned int >();
+	settings.batch_size = vm["batch"].as<unsigned int >();
+	settings.async = vm.count("async") > 0;
+	settings.max_in_flight = vm["in_flight"].as<unsigned int >();
+	settings.surrogate_fraction = vm["surrogate"].as<double >();
+	settings.neighbours = vm["neighbours"].as<unsigned int >();
+	settings.numa = vm.count("numa") > 0;
+	settings.chunk_size = vm["pipeline"].as<unsigned int >();
+	settings.seed_fraction = vm["init_fraction"].as<double >();
+	settings.save_hof = vm.count("save_hof") ? vm["save_hof"].as<std::string >() : "";
+	settings.memetic_count = vm["memetic"].as<unsigned int >();
+	settings.local_search_budget = vm["ls_budget"].as<unsigned int >();
+	settings.write_back = vm.count("baldwinian") ? BALDWINIAN : LAMARCKIAN;
+	settings.cellular = vm.count("cellular") > 0;
+	settings.grid_width = vm["grid_width"].as<unsigned int >();
+	settings.schedule_chunk_size = vm["schedule"].as<unsigned int >();
+	settings.autotune = vm["autotune"].as<unsigned int >();
+	settings.perf_counters = vm.count("counters") > 0;
+
+	if (vm.count("gp")) {
+		// The programs have a single objective, a synchronous fitness and a variable length.
+		if (settings.multi_objective || settings.async || settings.surrogate_fraction > 0 || vm.count("init_file")) {
+			out << "Invalid Input" << std::endl;
+			return -1;
+		}
+		// The shape of the programs is kept per thread, the Manager's threads are given it too.
+		unsigned int depth = vm["depth"].as<unsigned int >();
+		Program::setup(1, depth);
+
+		Problem<Instruction > problem;
+		problem.fitness = &calculateProgram;
+		problem.cost_hint = &programCost;
+		problem.thread_setup = boost::bind(&Program::setup, 1u, depth, 2u, -1.0f, 1.0f);
+		settings.seed_fraction = 0;
+		return measure_performance<Instruction>(settings, problem, out, report_out, job);
+	}
+
+	unsigned int max_value = settings.chromosome_size -1;
+	std::string genes = vm["genes"].as<std::string >();
+	if (genes == "8" || (genes == "auto" && max_value <= std::numeric_limits<unsigned char >::max())) {
+		return measure_queens<unsigned char>(vm, settings, out, report_out, job);
+	} else if (genes == "16" || (genes == "auto" && max_value <= std::numeric_limits<unsigned short >::max())) {
+		return measure_queens<unsigned short>(vm, settings, out, report_out, job);
+	} else if (genes == "32" || genes == "auto") {
+		return measure_queens<unsigned int>(vm, settings, out, report_out, job);
+	}
+	out << "Invalid Input" << std::endl;
+	return -1;
+}
+
+/**
+ * Run a job of the service mode, the output of the run is sent to the client line by line.
+ */
+int runJob(Job &job) {
+	std::ostringstream out;
+	int status = parse_args(job.getArgs(), out, out, &job);
+
+	std::istringstream lines(out.str());
+	std::string line;
+	while (std::getline(lines, line)) {
+		if (!line.empty()) {
+			job.send("output", line);
+		}
+	}
+	return status;
 }
 
 int main(int argc, char **argv) {
 
-	return parse_args(argc, argv);
+	return parse_args(std::vector<std::string >(argv + 1, argv + argc), std::cout, std::cerr, NULL);
 }
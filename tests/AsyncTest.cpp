@@ -0,0 +1,140 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+
+#include "Manager.hpp"
+#include "LatencyService.hpp"
+#include "Check.hpp"
+
+/**
+ * Drives the asynchronous fitness interface (Manager::run with a function that
+ * returns a future) against the stub latency service.
+ */
+
+static const unsigned int POPULATION = 200;
+static const unsigned int GENERATIONS = 10;
+static const unsigned int GENES = 16;
+static const double LATENCY = 0.002;
+
+// The service the fitness functions send their requests to, set by each test.
+static LatencyService *service = NULL;
+static boost::atomic<unsigned int > calls(0);
+
+// The fraction of ones, never 1.0 so the runs are not stopped by a solution.
+double countOnes(Chromosome<int > chromosome) {
+	unsigned int ones = 0;
+	for(unsigned int i = 0; i < chromosome.size(); i++) {
+		ones+= chromosome[i];
+	}
+	return (double) ones / (chromosome.size() + 1);
+}
+
+double failRemotely(Chromosome<int >) {
+	throw std::runtime_error("remote failure");
+}
+
+std::future<double > remoteFitness(Chromosome<int > chromosome) {
+	return service->submit(boost::bind(countOnes, chromosome));
+}
+
+// Every third call fails before a future is returned, every fifth answer fails remotely.
+std::future<double > unreliableFitness(Chromosome<int > chromosome) {
+	unsigned int call = calls++;
+	if(call % 3 == 0) {
+		throw std::system_error(std::make_error_code(std::errc::resource_unavailable_try_again));
+	}
+	if(call % 5 == 0) {
+		return service->submit(boost::bind(failRemotely, chromosome));
+	}
+	return service->submit(boost::bind(countOnes, chromosome));
+}
+
+Manager<int > *createManager() {
+	return new Manager<int >(std::vector<unsigned int >(1, POPULATION), GENES, GENERATIONS, 1, 0,
+		std::vector<double >(1, 0.1), std::vector<double >(1, 0.7), 1, 2);
+}
+
+// The evaluations of a generation are in flight at once, not one per worker thread.
+void testConcurrency() {
+	LatencyService stub(2, LATENCY);
+	service = &stub;
+
+	Manager<int > *manager = createManager();
+	manager->setMaxInFlight(1000);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	unsigned int generations = manager->run(&remoteFitness);
+	double seconds = std::chrono::duration<double >(std::chrono::steady_clock::now() - start).count();
+
+	CHECK(generations == GENERATIONS);
+	CHECK(manager->getStatistics().evaluations == POPULATION * GENERATIONS);
+	CHECK(stub.getMaxPending() >= POPULATION / 2);
+	// One evaluation at a time would take POPULATION * LATENCY a generation.
+	CHECK(seconds < GENERATIONS * POPULATION * LATENCY / 4);
+	delete manager;
+}
+
+// No more evaluations than the limit are in flight across the worker threads.
+void testInFlightLimit() {
+	LatencyService stub(2, LATENCY / 4);
+	service = &stub;
+
+	Manager<int > *manager = createManager();
+	manager->setMaxInFlight(8);
+	unsigned int generations = manager->run(&remoteFitness);
+
+	CHECK(generations == GENERATIONS);
+	CHECK(stub.getMaxPending() <= 8);
+	CHECK(stub.getMaxPending() > 1);
+	delete manager;
+}
+
+// Evaluations that fail, when started or remotely, get no fitness instead of stopping the run.
+void testFailures() {
+	LatencyService stub(2, LATENCY / 4);
+	service = &stub;
+	calls = 0;
+
+	Manager<int > *manager = createManager();
+	unsigned int generations = manager->run(&unreliableFitness);
+
+	CHECK(generations == GENERATIONS);
+	CHECK(manager->getStatistics().evaluations == POPULATION * GENERATIONS);
+	CHECK(calls == POPULATION * GENERATIONS);
+	delete manager;
+}
+
+int main() {
+	testConcurrency();
+	testInFlightLimit();
+	testFailures();
+
+	return checkResult();
+}
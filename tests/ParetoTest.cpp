@@ -0,0 +1,159 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cmath>		// isinf
+#include <vector>
+
+#include "Pareto.hpp"
+#include "Check.hpp"
+
+/**
+ * Checks the non-dominated sort and crowding distance of the multi-objective
+ * mode against small sets worked out by hand.
+ */
+
+std::vector<std::vector<double > > createObjectives(const double (*values)[3], unsigned int count,
+	unsigned int num_objectives) {
+	std::vector<std::vector<double > > objectives(count);
+	for(unsigned int i = 0; i < count; i++) {
+		objectives[i].assign(values[i], values[i] + num_objectives);
+	}
+	return objectives;
+}
+
+// Two objectives: the corners and a duplicated middle point are non-dominated,
+// the two points under the middle come next and the last point is alone. The
+// second objective has twice the range of the first.
+static const double TWO_OBJECTIVES[][3] = {
+	{1.0, 0.0}, {0.0, 2.0}, {0.5, 1.0}, {0.5, 1.0}, {0.4, 0.4}, {0.1, 0.2}, {0.2, 0.8}
+};
+static const unsigned int TWO_OBJECTIVE_RANKS[] = {0, 0, 0, 0, 1, 2, 1};
+
+// Three objectives, which are placed by checking every member of a front.
+static const double THREE_OBJECTIVES[][3] = {
+	{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {0.5, 0.5, 0.0}, {0.2, 0.2, 0.0}, {0.0, 0.0, 0.5},
+	{0.1, 0.1, 0.0}
+};
+static const unsigned int THREE_OBJECTIVE_RANKS[] = {0, 0, 0, 0, 1, 1, 2};
+
+void checkFronts(const std::vector<std::vector<unsigned int > > &fronts, const std::vector<unsigned int > &rank,
+	const unsigned int *expected, unsigned int count) {
+	CHECK(rank.size() == count);
+	CHECK(fronts.size() == 3);
+	unsigned int members = 0;
+	for(unsigned int f = 0; f < fronts.size(); f++) {
+		for(unsigned int i = 0; i < fronts[f].size(); i++) {
+			CHECK(rank[fronts[f][i]] == f);
+			members++;
+		}
+	}
+	CHECK(members == count);
+	for(unsigned int i = 0; i < rank.size() && i < count; i++) {
+		CHECK(rank[i] == expected[i]);
+	}
+}
+
+// Duplicates do not dominate each other so they share a front.
+void testTwoObjectives() {
+	std::vector<std::vector<double > > objectives = createObjectives(TWO_OBJECTIVES, 7, 2);
+	std::vector<std::vector<unsigned int > > fronts;
+	std::vector<unsigned int > rank;
+	Pareto::sort(objectives, fronts, rank);
+
+	checkFronts(fronts, rank, TWO_OBJECTIVE_RANKS, 7);
+	CHECK(fronts.size() == 3 && fronts[0].size() == 4 && fronts[1].size() == 2 && fronts[2].size() == 1);
+}
+
+void testThreeObjectives() {
+	std::vector<std::vector<double > > objectives = createObjectives(THREE_OBJECTIVES, 7, 3);
+	std::vector<std::vector<unsigned int > > fronts;
+	std::vector<unsigned int > rank;
+	Pareto::sort(objectives, fronts, rank);
+
+	checkFronts(fronts, rank, THREE_OBJECTIVE_RANKS, 7);
+}
+
+// Ranges ordered separately and merged, as the worker threads do, give the same fronts.
+void testMergedOrder() {
+	std::vector<std::vector<double > > objectives = createObjectives(TWO_OBJECTIVES, 7, 2);
+	std::vector<unsigned int > order;
+	for(unsigned int i = 0; i < objectives.size(); i++) {
+		order.push_back(i);
+	}
+	Pareto::order(objectives, order.begin(), order.begin() + 3);
+	Pareto::order(objectives, order.begin() + 3, order.end());
+	Pareto::merge(objectives, order.begin(), order.begin() + 3, order.end());
+
+	std::vector<std::vector<unsigned int > > fronts;
+	std::vector<unsigned int > rank;
+	Pareto::assign(objectives, order, fronts, rank);
+
+	checkFronts(fronts, rank, TWO_OBJECTIVE_RANKS, 7);
+}
+
+// The first front's corners are its boundaries, each middle point is half the range from
+// its neighbours in both objectives (the duplicate counts as a neighbour), so the
+// distances are normalized by the range of each objective. Fronts of one
+// or two members are all boundaries.
+void testCrowding() {
+	std::vector<std::vector<double > > objectives = createObjectives(TWO_OBJECTIVES, 7, 2);
+	std::vector<std::vector<unsigned int > > fronts;
+	std::vector<unsigned int > rank;
+	Pareto::sort(objectives, fronts, rank);
+	if(fronts.size() != 3) {
+		CHECK(fronts.size() == 3);
+		return;
+	}
+
+	std::vector<double > distance;
+	for(unsigned int f = 0; f < fronts.size(); f++) {
+		Pareto::crowding(objectives, fronts[f], distance);
+	}
+
+	CHECK(distance.size() == objectives.size());
+	CHECK(std::isinf(distance[0]));
+	CHECK(std::isinf(distance[1]));
+	CHECK(distance[2] == 1.0);
+	CHECK(distance[3] == 1.0);
+	CHECK(std::isinf(distance[4]));
+	CHECK(std::isinf(distance[6]));
+	CHECK(std::isinf(distance[5]));
+
+	// A front of equal points has no range, its ends are still boundaries.
+	std::vector<unsigned int > duplicates;
+	duplicates.push_back(2);
+	duplicates.push_back(3);
+	Pareto::crowding(objectives, duplicates, distance);
+	CHECK(std::isinf(distance[2]));
+	CHECK(std::isinf(distance[3]));
+}
+
+int main() {
+	testTwoObjectives();
+	testThreeObjectives();
+	testMergedOrder();
+	testCrowding();
+
+	return checkResult();
+}
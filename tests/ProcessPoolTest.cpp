@@ -0,0 +1,136 @@
+/**
+ *  The MIT License (MIT)
+ *
+ * Copyright (c) 2014  Joseph Heron, Jonathan Gillett
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <iostream>
+#include <cmath>		// isnan
+#include <cstdlib>		// abort
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "ProcessPool.hpp"
+#include "Check.hpp"
+
+/**
+ * Drives the process pool with an evaluator that crashes its worker on some of
+ * the inputs.
+ */
+
+static const unsigned int INPUTS = 64;
+static const unsigned int BATCH_SIZE = 16;
+
+// Squares the input, or crashes on a multiple of crash_every.
+static unsigned int crash_every = 0;
+
+void squareOrCrash(const char *input, double *output) {
+	unsigned int value = *reinterpret_cast<const unsigned int *>(input);
+	if(crash_every > 0 && value % crash_every == 0) {
+		abort();
+	}
+	output[0] = (double) value * value;
+}
+
+std::vector<unsigned int > createInputs() {
+	std::vector<unsigned int > inputs(INPUTS);
+	for(unsigned int i = 0; i < INPUTS; i++) {
+		inputs[i] = i + 1;
+	}
+	return inputs;
+}
+
+void evaluate(ProcessPool *pool, const std::vector<unsigned int > *inputs, std::vector<double > *outputs) {
+	pool->evaluate(reinterpret_cast<const char *>(&(*inputs)[0]), inputs->size(), &(*outputs)[0]);
+}
+
+// Without crashes every input is evaluated by the workers.
+void testEvaluate() {
+	crash_every = 0;
+	ProcessPool pool(2, BATCH_SIZE, sizeof(unsigned int), 1, &squareOrCrash);
+
+	std::vector<unsigned int > inputs = createInputs();
+	std::vector<double > outputs(INPUTS);
+	evaluate(&pool, &inputs, &outputs);
+
+	for(unsigned int i = 0; i < INPUTS; i++) {
+		CHECK(outputs[i] == (double) inputs[i] * inputs[i]);
+	}
+	CHECK(pool.getRestarts() == 0);
+	CHECK(pool.getFailures() == 0);
+}
+
+// Only the inputs that crash their worker are given up on, the rest of their batch is evaluated.
+void testCrashes() {
+	crash_every = 20;
+	ProcessPool pool(2, BATCH_SIZE, sizeof(unsigned int), 1, &squareOrCrash);
+
+	std::vector<unsigned int > inputs = createInputs();
+	std::vector<double > outputs(INPUTS);
+	evaluate(&pool, &inputs, &outputs);
+
+	for(unsigned int i = 0; i < INPUTS; i++) {
+		if(inputs[i] % crash_every == 0) {
+			CHECK(std::isnan(outputs[i]));
+		}
+		else {
+			CHECK(outputs[i] == (double) inputs[i] * inputs[i]);
+		}
+	}
+	CHECK(pool.getFailures() == INPUTS / crash_every);
+	CHECK(pool.getRestarts() > 0);
+
+	// The restarted workers still evaluate.
+	crash_every = 0;
+	inputs.assign(1, 7);
+	outputs.assign(1, 0.0);
+	evaluate(&pool, &inputs, &outputs);
+	CHECK(outputs[0] == 49.0);
+}
+
+// Several threads use the pool while workers are restarted.
+void testConcurrentCrashes() {
+	crash_every = 20;
+	ProcessPool pool(2, BATCH_SIZE, sizeof(unsigned int), 1, &squareOrCrash);
+
+	std::vector<unsigned int > inputs = createInputs();
+	std::vector<std::vector<double > > outputs(4, std::vector<double >(INPUTS));
+	boost::thread_group threads;
+	for(unsigned int i = 0; i < outputs.size(); i++) {
+		threads.create_thread(boost::bind(evaluate, &pool, &inputs, &outputs[i]));
+	}
+	threads.join_all();
+
+	for(unsigned int t = 0; t < outputs.size(); t++) {
+		for(unsigned int i = 0; i < INPUTS; i++) {
+			CHECK(std::isnan(outputs[t][i]) == (inputs[i] % crash_every == 0));
+		}
+	}
+	CHECK(pool.getFailures() == outputs.size() * (INPUTS / crash_every));
+}
+
+int main() {
+	testEvaluate();
+	testCrashes();
+	testConcurrentCrashes();
+
+	return checkResult();
+}